@@ -0,0 +1,228 @@
+/*
+ * batch.c
+ * Serial mode lines go through expr.c token by token, as keys would.
+ */ 
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <avr/pgmspace.h>
+#include "batch.h"
+#include "expr.h"
+#include "serial.h"
+
+static uint8_t reply_P(char *reply, PGM_P text)
+{
+	strcpy_P(reply, text);
+	return strlen(reply);
+}
+
+static uint8_t base_of(char c)
+{
+	switch (c)
+	{
+		case 'b': return 2;
+		case 'o': return 8;
+		case 'd': return 10;
+		case 'x': return 16;
+	}
+	return 0;
+}
+
+static uint8_t digit_of(char c, uint8_t base)							//digit value, 0xff when c isn't a digit in this base
+{
+	uint8_t d;
+	
+	if (c >= 'a' && c <= 'f')
+		c -= 'a' - 'A';
+	if (c >= '0' && c <= '9')
+		d = c - '0';
+	else if (c >= 'A' && c <= 'F')
+		d = c - 'A' + 10;
+	else
+		return 0xff;
+	
+	return d < base ? d : 0xff;
+}
+
+static bool word_size(const char *s)
+{
+	uint16_t bits = 0;
+	uint8_t n;
+	
+	for (n = 0; n < 3 && *s >= '0' && *s <= '9'; n++)
+	{
+		bits = bits * 10 + *s++ - '0';
+	}
+	if (*s || n > 2 || (bits != 8 && bits != 16 && bits != 32 && bits != 64))	//no digits fails here too
+	{
+		return false;
+	}
+	
+	calc_set_word(bits, calc_signed);
+	return true;
+}
+
+/*
+ * Operands and operators have to alternate, the engine would otherwise take
+ * a second operator as a correction of the first and a second number as the
+ * one being typed. A minus where an operand belongs is only taken at the
+ * start and after '(', where the engine reads it as 0 - x.
+ */
+static bool parse(const char *s, uint8_t base)
+{
+	calc_t v = 0;
+	bool in_num = false, operand = true, invert = false, ok = true;		//operand: a number or '(' comes next
+	uint8_t depth = 0, d;
+	char c, prev = '(';														//last token, the line starts like a group
+	
+	for (; ok; s++)
+	{
+		c = *s;
+		d = digit_of(c, base);
+		
+		if (d != 0xff)
+		{
+			if (!in_num && !operand)
+			{
+				return false;
+			}
+			v = in_num ? calc_digit(v, base, d) : d;
+			in_num = true;
+			operand = false;
+			prev = c;
+			ok = expr_number(invert ? calculate(v, 0, '~') : v);
+			continue;
+		}
+		
+		if (in_num)
+		{
+			in_num = false;
+			invert = false;
+		}
+		if (invert && c != '~')												//~ sticks to the digits after it
+		{
+			return false;
+		}
+		
+		switch (c)
+		{
+			case 0:
+				return !operand && !depth;
+			case ' ':
+				break;
+			case '~':
+				ok = operand;
+				invert = !invert;
+				break;
+			case '(':
+				ok = operand;
+				depth++;
+				ok = ok && expr_open();
+				break;
+			case ')':
+				ok = !operand && depth;
+				depth--;
+				ok = ok && expr_close();
+				break;
+			case '-':
+				ok = !operand || prev == '(';
+				operand = true;
+				ok = ok && expr_op(c);
+				break;
+			case '*':
+				c = 'x';
+			case '+': case 'x': case '/': case '%':
+			case '&': case '|': case '^':
+			case '<': case '>':
+				if ((c == '<' || c == '>') && s[1] == c)					//<< and >>, the engine's ops are one character
+				{
+					s++;
+				}
+				ok = !operand;
+				operand = true;
+				ok = ok && expr_op(c);
+				break;
+			default:
+				ok = false;
+		}
+		if (c != ' ')
+		{
+			prev = c;
+		}
+	}
+	
+	return false;
+}
+
+uint8_t batch_eval(const char *line, char *reply, calc_t *value)
+{
+	static const uint8_t bases[] PROGMEM = {10, 16, 8, 2};
+	uint8_t base = 10, len = 0, i;
+	calc_t v;
+	
+	if (line[0] == SERIAL_LONG)
+	{
+		return reply_P(reply, PSTR("ERR LONG\n"));
+	}
+	if (line[0] == SERIAL_OVERRUN)
+	{
+		return reply_P(reply, PSTR("ERR OVERRUN\n"));
+	}
+	if (line[0] && line[1] == ':')
+	{
+		if (line[0] == 'w')
+		{
+			return word_size(line + 2) ? reply_P(reply, PSTR("OK\n")) : reply_P(reply, PSTR("ERR WORD\n"));
+		}
+		if (line[0] == 's' || line[0] == 'u')
+		{
+			if (line[2])
+			{
+				return reply_P(reply, PSTR("ERR SYNTAX\n"));
+			}
+			calc_set_word(calc_bits, line[0] == 's');
+			return reply_P(reply, PSTR("OK\n"));
+		}
+		
+		base = base_of(line[0]);
+		if (!base)
+		{
+			return reply_P(reply, PSTR("ERR BASE\n"));
+		}
+		line += 2;
+	}
+	
+	expr_clear();
+	calc_clear_status();
+	
+	if (!parse(line, base) || expr_empty())
+	{
+		expr_clear();
+		return reply_P(reply, PSTR("ERR SYNTAX\n"));
+	}
+	
+	v = expr_value();
+	expr_clear();
+	
+	if (calc_status & CALC_DIV_ZERO)
+	{
+		return reply_P(reply, PSTR("ERR DIV BY 0\n"));
+	}
+	if (calc_status & CALC_OVERFLOW)
+	{
+		return reply_P(reply, PSTR("ERR OVERFLOW\n"));
+	}
+	
+	for (i = 0; i < sizeof(bases); i++)
+	{
+		convert_system(v, pgm_read_byte(&bases[i]), reply + len);
+		while (reply[len] != '_')
+		{
+			len++;
+		}
+		reply[len++] = i < sizeof(bases) - 1 ? ' ' : '\n';
+	}
+	
+	*value = v;
+	return len;
+}
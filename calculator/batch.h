@@ -0,0 +1,25 @@
+/*
+ * batch.h
+ * Text expressions for the serial mode, evaluated by the same engine as the keypad.
+ */ 
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include <stdint.h>
+#include "calculatorFunc.h"
+
+/*
+ * Line: [base ':'] expression, base is b, o, d or x and d when left out.
+ * Operators + - * x / % & | ^ << >> ( ), ~ right in front of a number
+ * inverts it and ~~ cancels. A leading minus, or one after '(', negates.
+ * Numbers and operators alternate and brackets close, anything else is
+ * ERR SYNTAX rather than a guess.
+ * w:8, w:16, w:32 or w:64 sets the word size, s: and u: make it signed or
+ * unsigned.
+ * Reply: the value in DEC HEX OCT BIN, or ERR and the reason; newline ended.
+ * A line that didn't fit the receiver is ERR LONG, one that came in while
+ * it was full ERR OVERRUN, so every line gets its own reply.
+ */
+uint8_t batch_eval(const char *line, char *reply, calc_t *value);	//reply length, value is left alone on errors
+
+#endif /* BATCH_H_ */
@@ -0,0 +1,56 @@
+/*
+ * bench.h
+ * Zones measured by the simavr benchmark, shared by the firmware and the runner.
+ */ 
+#ifndef BENCH_H_
+#define BENCH_H_
+
+/*
+ * The firmware writes a zone id to TWBR when the zone starts and BENCH_END
+ * when it stops; TWI is not used on this board, so the register is free.
+ * The runner timestamps the writes with the simulated cycle counter.
+ */
+#define BENCH_MARK_ADDR 0x20	//TWBR in data space
+#define BENCH_END 0xfe
+#define BENCH_DONE 0xff
+
+#define BENCH_ZONES \
+	ZONE(BOOT, "boot_to_ready") \
+	ZONE(BOOT_REST, "boot_rest_of_screen") \
+	ZONE(SCREEN_COLOR, "LCD_screen_color") \
+	ZONE(DRAW_CALC, "draw_calc") \
+	ZONE(PRINT_STR, "print_str_16_chars") \
+	ZONE(CONVERT_DEC, "convert_dec_10_digits") \
+	ZONE(CONVERT_BIN, "convert_bin_32_digits") \
+	ZONE(FORMAT_DEC8, "convert_system_dec_8bit") \
+	ZONE(FORMAT_DEC16, "convert_system_dec_16bit") \
+	ZONE(FORMAT_DEC32, "convert_system_dec_32bit") \
+	ZONE(FORMAT_DEC64, "convert_system_dec_64bit") \
+	ZONE(FORMAT_HEX8, "convert_system_hex_8bit") \
+	ZONE(FORMAT_HEX16, "convert_system_hex_16bit") \
+	ZONE(FORMAT_HEX32, "convert_system_hex_32bit") \
+	ZONE(FORMAT_HEX64, "convert_system_hex_64bit") \
+	ZONE(FORMAT_BIN8, "convert_system_bin_8bit") \
+	ZONE(FORMAT_BIN16, "convert_system_bin_16bit") \
+	ZONE(FORMAT_BIN32, "convert_system_bin_32bit") \
+	ZONE(FORMAT_BIN64, "convert_system_bin_64bit") \
+	ZONE(MUL8, "calculate_mul_8bit") \
+	ZONE(DIV8, "calculate_div_8bit") \
+	ZONE(MUL16, "calculate_mul_16bit") \
+	ZONE(DIV16, "calculate_div_16bit") \
+	ZONE(MUL32, "calculate_mul_32bit") \
+	ZONE(DIV32, "calculate_div_32bit") \
+	ZONE(MUL64, "calculate_mul_64bit") \
+	ZONE(DIV64, "calculate_div_64bit") \
+	ZONE(TYPE_BIN16, "scenario_type_16_digit_bin") \
+	ZONE(HEX_TO_DEC, "scenario_switch_hex_to_dec")
+
+enum
+{
+#define ZONE(id, name) BENCH_##id,
+	BENCH_ZONES
+#undef ZONE
+	BENCH_CNT
+};
+
+#endif /* BENCH_H_ */
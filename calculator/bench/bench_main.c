@@ -0,0 +1,106 @@
+/*
+ * bench_main.c
+ * Benchmark firmware: the real drawing and arithmetic code, driven without
+ * touch input, with every measured section wrapped in a TWBR mark.
+ * Interrupts stay off so the touch tick doesn't land inside a zone.
+ */ 
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
+#include <avr/interrupt.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "../calculatorFunc.h"
+#include "../expr.h"
+#include "../input.h"
+#include "../keypad.c"					//key actions, and the table to look indexes up in
+#include "bench.h"
+
+#define BENCH_MARK(id) (TWBR = (id))
+#define BENCH(id, code) do { BENCH_MARK(BENCH_##id); code; BENCH_MARK(BENCH_END); } while (0)
+
+/*main.c, built with main renamed*/
+void init(void);
+void draw_calc(void);
+void boot_pad(void);
+bool boot_step(void);
+void LCD_screen_color(unsigned int color);
+void print_str(unsigned int x_pos, unsigned int y_pos, unsigned char font_size, unsigned int colour, unsigned int back_colour, const char *ch);
+void key_press(uint8_t k, uint8_t type);
+void frame_render(void);
+
+static volatile calc_t sink;			//keeps results the optimiser would otherwise drop
+static char out[NUM_CHARS + 1];
+
+static void press(uint8_t action, char value)							//first key with this action and value, as if it was touched, and its frame
+{
+	uint8_t k;
+	
+	for (k = 0; k < sizeof(keys) / sizeof(keys[0]); k++)
+	{
+		if (pgm_read_byte(&keys[k].action) == action && pgm_read_byte(&keys[k].value) == value)
+		{
+			key_press(k, EVENT_PRESS);
+			frame_render();
+			return;
+		}
+	}
+}
+
+int main(void)
+{
+	uint8_t i;
+	
+	BENCH(BOOT, init(); boot_pad());									//cold boot until the pad takes touches
+	BENCH(BOOT_REST, while (boot_step()));
+	BENCH(SCREEN_COLOR, LCD_screen_color(0x0000));
+	BENCH(DRAW_CALC, draw_calc());
+	BENCH(PRINT_STR, print_str(20, 60, 3, 0xffff, 0x0000, "0123456789ABCDEF"));
+	
+	BENCH(CONVERT_DEC, sink = convert(10, "1234567890_"));
+	BENCH(CONVERT_BIN, sink = convert(2, "10110011100011110000111110000011_"));
+	
+	calc_set_word(8, true);												//one value near the top of each word, formatted in three bases, then mul and div
+	BENCH(FORMAT_DEC8, convert_system(-123, 10, out));
+	BENCH(FORMAT_HEX8, convert_system(0x5A, 16, out));
+	BENCH(FORMAT_BIN8, convert_system(0x5A, 2, out));
+	BENCH(MUL8, sink = calculate(11, 11, 'x'));
+	BENCH(DIV8, sink = calculate(127, 3, '/'));
+	calc_set_word(16, true);
+	BENCH(FORMAT_DEC16, convert_system(-12345, 10, out));
+	BENCH(FORMAT_HEX16, convert_system(0x5AA5, 16, out));
+	BENCH(FORMAT_BIN16, convert_system(0x5AA5, 2, out));
+	BENCH(MUL16, sink = calculate(181, 181, 'x'));
+	BENCH(DIV16, sink = calculate(32767, 123, '/'));
+	calc_set_word(32, true);
+	BENCH(FORMAT_DEC32, convert_system(-2147483647L, 10, out));
+	BENCH(FORMAT_HEX32, convert_system(0x5A5AA5A5L, 16, out));
+	BENCH(FORMAT_BIN32, convert_system(0x5A5AA5A5L, 2, out));
+	BENCH(MUL32, sink = calculate(46341, 46339, 'x'));
+	BENCH(DIV32, sink = calculate(2147483647L, 12345, '/'));
+	calc_set_word(64, true);
+	BENCH(FORMAT_DEC64, convert_system(-9223372036854775807LL, 10, out));
+	BENCH(FORMAT_HEX64, convert_system(0x123456789ABCDEF0LL, 16, out));
+	BENCH(FORMAT_BIN64, convert_system(0x123456789ABCDEF0LL, 2, out));
+	BENCH(MUL64, sink = calculate(3037000499LL, 3037000499LL, 'x'));
+	BENCH(DIV64, sink = calculate(9223372036854775807LL, 12345, '/'));
+	calc_set_word(32, true);
+	
+	press(KEY_CLEAR, 0);
+	press(KEY_BASE, 2);
+	BENCH(TYPE_BIN16, for (i = 0; i < 16; i++) press(KEY_DIGIT, i & 1 ? '0' : '1'));
+	
+	press(KEY_CLEAR, 0);
+	press(KEY_BASE, 16);
+	for (i = 0; i < 8; i++)
+	{
+		press(KEY_DIGIT, '7');
+	}
+	BENCH(HEX_TO_DEC, press(KEY_BASE, 10));
+	
+	BENCH_MARK(BENCH_DONE);
+	cli();
+	sleep_cpu();														//simavr stops on sleep with interrupts off
+	
+	return 0;
+}
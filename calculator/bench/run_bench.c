@@ -0,0 +1,110 @@
+/*
+ * run_bench.c
+ * Runs the benchmark firmware under simavr and writes the cycles of every
+ * zone as CSV, one line per zone: name, cycles, microseconds at F_CPU.
+ *
+ *   run_bench FIRMWARE.elf [OUT.csv]
+ */ 
+#include <stdio.h>
+#include <stdlib.h>
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include "bench.h"
+
+#define F_CPU 7372800UL
+
+static const char *names[BENCH_CNT] =
+{
+#define ZONE(id, name) name,
+	BENCH_ZONES
+#undef ZONE
+};
+
+static avr_cycle_count_t start[BENCH_CNT], cycles[BENCH_CNT];
+static int current = -1;
+static int done = 0;
+
+static void mark(struct avr_t *avr, avr_io_addr_t addr, uint8_t v, void *param)
+{
+	avr->data[addr] = v;
+	
+	if (v == BENCH_DONE)
+	{
+		done = 1;
+	}
+	else if (v == BENCH_END)
+	{
+		if (current >= 0)
+		{
+			cycles[current] = avr->cycle - start[current];
+			current = -1;
+		}
+	}
+	else if (v < BENCH_CNT)
+	{
+		current = v;
+		start[v] = avr->cycle;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	elf_firmware_t firmware = {{0}};
+	avr_t *avr;
+	FILE *out = stdout;
+	int state, i;
+	
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s FIRMWARE.elf [OUT.csv]\n", argv[0]);
+		return 2;
+	}
+	
+	if (elf_read_firmware(argv[1], &firmware))
+	{
+		fprintf(stderr, "run_bench: can't read %s\n", argv[1]);
+		return 1;
+	}
+	
+	avr = avr_make_mcu_by_name("atmega32");
+	if (!avr)
+	{
+		fprintf(stderr, "run_bench: simavr has no atmega32 core\n");
+		return 1;
+	}
+	avr_init(avr);
+	avr->frequency = F_CPU;
+	avr_load_firmware(avr, &firmware);
+	avr_register_io_write(avr, BENCH_MARK_ADDR, mark, NULL);
+	
+	do
+	{
+		state = avr_run(avr);
+	}
+	while (!done && state != cpu_Done && state != cpu_Crashed);
+	
+	if (!done)
+	{
+		fprintf(stderr, "run_bench: firmware stopped before the last zone\n");
+		return 1;
+	}
+	
+	if (argc > 2 && !(out = fopen(argv[2], "w")))
+	{
+		fprintf(stderr, "run_bench: can't write %s\n", argv[2]);
+		return 1;
+	}
+	
+	fprintf(out, "zone,cycles,us\n");
+	for (i = 0; i < BENCH_CNT; i++)
+	{
+		fprintf(out, "%s,%llu,%.1f\n", names[i], (unsigned long long)cycles[i], cycles[i] * 1e6 / F_CPU);
+	}
+	
+	if (out != stdout)
+	{
+		fclose(out);
+	}
+	
+	return 0;
+}
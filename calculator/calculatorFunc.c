@@ -0,0 +1,548 @@
+/*
+ * calculatorFunc.c
+ * Number parsing, formatting and arithmetic at a selectable word size.
+ * 16 bit work stays on native int, wider words go through the kernels below.
+ */ 
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <avr/pgmspace.h>
+#include "calculatorFunc.h"
+#include "prof.h"
+
+uint8_t calc_bits = 32;
+bool calc_signed = true;
+uint8_t calc_status = 0;
+
+void calc_set_word(uint8_t bits, bool is_signed)
+{
+	calc_bits = bits;
+	calc_signed = is_signed;
+}
+
+void calc_clear_status(void)
+{
+	calc_status = 0;
+}
+
+static uint64_t calc_mask(void)
+{
+	return calc_bits == 64 ? UINT64_MAX : ((uint64_t)1 << calc_bits) - 1;
+}
+
+calc_t calc_norm(calc_t value)											//cut to the word and extend back, wrapping like the hardware would
+{
+	uint64_t v = (uint64_t)value & calc_mask();
+	
+	if (calc_signed && calc_bits < 64 && (v >> (calc_bits - 1)) & 1)
+	{
+		v |= ~calc_mask();
+	}
+	
+	return (calc_t)v;
+}
+
+static uint64_t calc_limit(bool negative)								//largest magnitude the word can hold
+{
+	if (!calc_signed)
+	{
+		return calc_mask();
+	}
+	
+	return (calc_mask() >> 1) + negative;
+}
+
+static calc_t calc_make(bool negative, uint64_t magnitude)				//signed result from a magnitude, flags what doesn't fit
+{
+	if (magnitude > calc_limit(negative) || (negative && !calc_signed && magnitude))
+	{
+		calc_status |= CALC_OVERFLOW;
+	}
+	
+	return calc_norm(negative ? -(calc_t)magnitude : (calc_t)magnitude);
+}
+
+static bool calc_negative(calc_t v)
+{
+	return calc_signed && v < 0;
+}
+
+static uint64_t calc_abs(calc_t v)
+{
+	return calc_negative(v) ? -(uint64_t)v : (uint64_t)v & calc_mask();
+}
+
+/*
+ * Bitwise kernels, one per word size so an 8 bit XOR is a single eor on a
+ * byte instead of eight. Shifts past the word clear it, or fill it with the
+ * sign on a signed right shift. Rotates go modulo the word size.
+ */
+#define BITOPS(bits) \
+static calc_t bitops_##bits(calc_t a, calc_t b, char op) \
+{ \
+	uint##bits##_t x = a, y = b; \
+	uint8_t n = (uint64_t)b < bits ? (uint8_t)b : bits; \
+	uint8_t turn = (uint8_t)b & (bits - 1); \
+	bool sign = calc_signed && (int##bits##_t)x < 0; \
+	\
+	switch (op) \
+	{ \
+		case '&': x &= y; break; \
+		case '|': x |= y; break; \
+		case '^': x ^= y; break; \
+		case '~': x = ~x; break; \
+		case '<': x = n < bits ? (uint##bits##_t)(x << n) : 0; break; \
+		case '>': x = n < bits ? (sign ? ~(uint##bits##_t)((uint##bits##_t)~x >> n) : x >> n) : (sign ? (uint##bits##_t)~0 : 0); break; \
+		case 'L': x = (uint##bits##_t)(x << turn) | (x >> ((bits - turn) & (bits - 1))); break; \
+		case 'R': x = (x >> turn) | (uint##bits##_t)(x << ((bits - turn) & (bits - 1))); break; \
+	} \
+	\
+	return calc_signed ? (calc_t)(int##bits##_t)x : (calc_t)x; \
+}
+
+BITOPS(8)
+BITOPS(16)
+BITOPS(32)
+BITOPS(64)
+
+static calc_t bitops(calc_t a, calc_t b, char op)
+{
+	switch (calc_bits)
+	{
+		case 8: return bitops_8(a, b, op);
+		case 16: return bitops_16(a, b, op);
+		case 32: return bitops_32(a, b, op);
+	}
+	return bitops_64(a, b, op);
+}
+
+/*
+ * 64 x 64 multiply from 16 x 16 -> 32 partial products, which avr-gcc maps
+ * onto the hardware mul (__umulhisi3) instead of the generic __muldi3.
+ * Partials past bit 63 only set the overflow flag.
+ */
+static uint64_t mul_u64(uint64_t a, uint64_t b, bool *overflow)
+{
+	uint16_t x[4], y[4];
+	uint32_t p;
+	uint64_t sum = 0;
+	uint8_t i, j;
+	
+	*overflow = false;
+	for (i = 0; i < 4; i++)
+	{
+		x[i] = a >> (16 * i);
+		y[i] = b >> (16 * i);
+	}
+	
+	for (i = 0; i < 4; i++)
+	{
+		if (!x[i]) continue;
+		
+		for (j = 0; j < 4; j++)
+		{
+			if (!y[j]) continue;
+			
+			p = (uint32_t)x[i] * y[j];
+			if (i + j > 3 || (i + j == 3 && p >> 16))
+			{
+				*overflow = true;
+			}
+			else
+			{
+				uint64_t part = (uint64_t)p << (16 * (i + j));
+				sum += part;
+				if (sum < part)
+				{
+					*overflow = true;
+				}
+			}
+		}
+	}
+	
+	return sum;
+}
+
+/*
+ * Shift-subtract division that starts at the divisor's highest useful bit,
+ * so small operands take a few passes instead of the 64 of __udivdi3.
+ */
+static uint64_t div_u64(uint64_t n, uint64_t d, uint64_t *rem)
+{
+	uint64_t q = 0;
+	uint8_t k = 0;
+	
+	if (n < d)
+	{
+		*rem = n;
+		return 0;
+	}
+	
+	while (!(d >> 63) && (d << 1) <= n)
+	{
+		d <<= 1;
+		k++;
+	}
+	
+	do
+	{
+		q <<= 1;
+		if (n >= d)
+		{
+			n -= d;
+			q |= 1;
+		}
+		d >>= 1;
+	}
+	while (k--);
+	
+	*rem = n;
+	return q;
+}
+
+static uint16_t div_u16(uint16_t n, uint16_t d, uint16_t *rem)			//div_u64 for the 16 bit path, instead of __divmodhi4
+{
+	uint16_t q = 0;
+	uint8_t k = 0;
+	
+	if (n < d)
+	{
+		*rem = n;
+		return 0;
+	}
+	
+	while (!(d >> 15) && (d << 1) <= n)
+	{
+		d <<= 1;
+		k++;
+	}
+	
+	do
+	{
+		q <<= 1;
+		if (n >= d)
+		{
+			n -= d;
+			q |= 1;
+		}
+		d >>= 1;
+	}
+	while (k--);
+	
+	*rem = n;
+	return q;
+}
+
+char num_to_char(int n)
+{
+	if (n < 10)
+		return n + 48;
+	if (n < 16)
+		return n + 'A' - 10;
+	return 0;
+}
+
+int char_to_num(char c)
+{
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return c - '0';
+}
+
+static uint8_t base_shift(int system)									//bits per digit for 2, 8 and 16, 0 when digits aren't bit fields
+{
+	switch (system)
+	{
+		case 2: return 1;
+		case 8: return 3;
+		case 16: return 4;
+	}
+	return 0;
+}
+
+/*
+ * Power of two bases: digits are bit fields, so the count comes from the
+ * top set bit and each digit is written straight into its final place.
+ */
+static uint8_t format_pow2(uint64_t v, uint8_t shift, char *out)
+{
+	uint8_t bits = 0, digits, i;
+	uint8_t mask = (1 << shift) - 1;
+	
+	while (bits < 64 && v >> bits)
+	{
+		bits++;
+	}
+	digits = bits ? (bits + shift - 1) / shift : 1;
+	
+	for (i = digits; i > 0; i--)
+	{
+		out[i - 1] = num_to_char(v & mask);
+		v >>= shift;
+	}
+	
+	return digits;
+}
+
+/*
+ * Decimal without division: subtract powers of ten from the top, the count
+ * is the digit. At most 9 subtractions per digit, values that fit 32 bits
+ * use the low half of the table and 32 bit compares.
+ */
+static const uint64_t pow10_table[20] PROGMEM =
+{
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL,
+	100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+	10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+	1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+static uint8_t format_dec(uint64_t v, char *out)
+{
+	uint8_t k, i = 0;
+	char d;
+	
+	if (v <= UINT32_MAX)
+	{
+		uint32_t w = v, p;
+		
+		for (k = 9; k > 0 && w < pgm_read_dword(&pow10_table[k]); k--);	//low dword of each entry, the table is little endian
+		
+		do
+		{
+			p = pgm_read_dword(&pow10_table[k]);
+			for (d = '0'; w >= p; d++)
+			{
+				w -= p;
+			}
+			out[i++] = d;
+		}
+		while (k--);
+	}
+	else
+	{
+		uint64_t p;
+		
+		k = 19;
+		memcpy_P(&p, &pow10_table[k], sizeof(p));
+		while (v < p)
+		{
+			memcpy_P(&p, &pow10_table[--k], sizeof(p));
+		}
+		
+		do
+		{
+			memcpy_P(&p, &pow10_table[k], sizeof(p));
+			for (d = '0'; v >= p; d++)
+			{
+				v -= p;
+			}
+			out[i++] = d;
+		}
+		while (k--);
+	}
+	
+	return i;
+}
+
+static calc_t parse_pow2(uint8_t shift, const char *number, bool negative)	//digits are the word's bit pattern, two's complement
+{
+	uint64_t n = 0;
+	
+	for (int i = negative; number[i] != '_' && number[i]; i++)
+	{
+		if (n >> (64 - shift) || ((n << shift) & ~calc_mask()))
+		{
+			calc_status |= CALC_OVERFLOW;
+		}
+		n = (n << shift) | char_to_num(number[i]);
+	}
+	
+	return calc_norm(negative ? -(calc_t)n : (calc_t)n);
+}
+
+calc_t convert(int system, const char *number)
+{
+	uint64_t n = 0, limit, max_before;
+	bool negative = number[0] == '-';
+	uint8_t d, shift = base_shift(system);
+	
+	if (shift)
+	{
+		return parse_pow2(shift, number, negative);
+	}
+	
+	limit = calc_limit(negative);
+	max_before = limit / system;										//one division per parse, not per digit
+	
+	for (int i = negative; number[i] != '_' && number[i]; i++)
+	{
+		d = char_to_num(number[i]);
+		if (n > max_before || n * system > limit - d)
+		{
+			calc_status |= CALC_OVERFLOW;
+		}
+		n = n * system + d;
+	}
+	
+	return calc_norm(negative ? -(calc_t)n : (calc_t)n);
+}
+
+calc_t calc_digit(calc_t value, int system, uint8_t digit)				//value * system + digit, for typing without reparsing
+{
+	bool negative = calc_negative(value), wrap;
+	uint64_t n = calc_abs(value);
+	uint8_t shift = base_shift(system);
+	
+	if (shift)															//shifted into the bit pattern, the top digit may set the sign
+	{
+		n = (uint64_t)value & calc_mask();
+		if (n >> (64 - shift) || ((n << shift) & ~calc_mask()))
+		{
+			calc_status |= CALC_OVERFLOW;
+		}
+		return calc_norm((n << shift) | digit);
+	}
+	else																//times ten as two shifts, the bounds fold at compile time
+	{
+		wrap = n > UINT64_MAX / 10 || (n == UINT64_MAX / 10 && digit > UINT64_MAX % 10);
+		n = (n << 3) + (n << 1) + digit;
+	}
+	
+	if (wrap)
+	{
+		calc_status |= CALC_OVERFLOW;
+	}
+	
+	return calc_make(negative, n);
+}
+
+/*
+ * Backspace: value without its last digit, which the caller still has as
+ * text. In decimal n - digit is a multiple of ten, so halving it and
+ * multiplying by the inverse of 5 modulo 2^64, -0x3333333333333333, divides
+ * exactly with shifts and adds.
+ */
+calc_t calc_undigit(calc_t value, int system, uint8_t digit)
+{
+	uint8_t shift = base_shift(system);
+	uint64_t n;
+	
+	if (shift)
+	{
+		return calc_norm(((uint64_t)value & calc_mask()) >> shift);
+	}
+	
+	n = (calc_abs(value) - digit) >> 1;
+	n += n << 1;														//x 0x3333333333333333 as x 3 x 0x1111111111111111
+	n += n << 4;
+	n += n << 8;
+	n += n << 16;
+	n += n << 32;
+	
+	return calc_make(calc_negative(value), -n);
+}
+
+void convert_system(calc_t res, int system, char *out)
+{
+	int i = 0;
+	uint8_t shift = base_shift(system);
+	bool negative = !shift && calc_negative(res);						//BIN, OCT and HEX show the two's complement pattern
+	uint64_t v = negative ? calc_abs(res) : (uint64_t)res & calc_mask();
+	
+	PROF_BEGIN(CONVERT_SYSTEM);
+	if (negative)
+		out[i++] = '-';
+	i += shift ? format_pow2(v, shift, out + i) : format_dec(v, out + i);	//digits land in final order, nothing to reverse
+	out[i] = '_';
+	PROF_END(CONVERT_SYSTEM);
+}
+
+calc_t calculate(calc_t a, calc_t b, char sign)
+{
+	bool neg_a = calc_negative(a), neg_b = calc_negative(b), overflow;
+	uint64_t x = calc_abs(a), y = calc_abs(b), r;
+	
+	switch (sign)
+	{
+		case '&': case '|': case '^': case '~':
+		case '<': case '>': case 'L': case 'R':
+			return bitops(a, b, sign);
+	}
+	
+	if (calc_bits == 16 && calc_signed)									//native int and hardware mul, no cycle count yet
+	{
+		int32_t wide = 0;
+		
+		if (sign == '+') wide = (int32_t)(int16_t)a + (int16_t)b;
+		else if (sign == '-') wide = (int32_t)(int16_t)a - (int16_t)b;
+		else if (sign == 'x') wide = (int32_t)(int16_t)a * (int16_t)b;
+		else if (sign == '/' || sign == '%')
+		{
+			if (b == 0)
+			{
+				calc_status |= CALC_DIV_ZERO;
+				return 0;
+			}
+			uint16_t rem, q = div_u16(x, y, &rem);						//magnitudes, INT16_MIN's still fits
+			
+			if (sign == '/')
+			{
+				wide = neg_a != neg_b ? -(int32_t)q : q;				//INT16_MIN / -1 comes out as 32768, an overflow
+			}
+			else
+			{
+				wide = neg_a ? -(int32_t)rem : rem;						//the remainder takes the dividend's sign, as in C
+			}
+		}
+		
+		if (wide > INT16_MAX || wide < INT16_MIN)
+		{
+			calc_status |= CALC_OVERFLOW;
+		}
+		return (int16_t)wide;
+	}
+	
+	if (sign == '+' || sign == '-')
+	{
+		if (sign == '-')
+		{
+			neg_b = !neg_b;
+		}
+		
+		if (neg_a == neg_b)
+		{
+			r = x + y;
+			if (r < x)
+			{
+				calc_status |= CALC_OVERFLOW;
+			}
+			return calc_make(neg_a, r);
+		}
+		
+		return x >= y ? calc_make(neg_a, x - y) : calc_make(neg_b, y - x);
+	}
+	
+	if (sign == 'x')
+	{
+		r = mul_u64(x, y, &overflow);
+		if (overflow)
+		{
+			calc_status |= CALC_OVERFLOW;
+		}
+		return calc_make(neg_a != neg_b, r);
+	}
+	
+	if (sign == '/' || sign == '%')
+	{
+		if (y == 0)
+		{
+			calc_status |= CALC_DIV_ZERO;
+			return 0;
+		}
+		x = div_u64(x, y, &r);
+		return sign == '/' ? calc_make(neg_a != neg_b, x) : calc_make(neg_a, r);	//remainder takes the dividend's sign, as in C
+	}
+	
+	return 0;
+}
@@ -0,0 +1,36 @@
+/*
+ * calculatorFunc.h
+ * Number parsing, formatting and arithmetic at a selectable word size.
+ */ 
+#ifndef CALCULATORFUNC_H_
+#define CALCULATORFUNC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define NUM_CHARS 65			//64 binary digits and a sign
+
+/*status flags, sticky until calc_clear_status*/
+#define CALC_OVERFLOW 0x01
+#define CALC_DIV_ZERO 0x02
+/*end status flags*/
+
+typedef int64_t calc_t;			//value at the current word size: sign extended when signed, zero extended when not
+
+extern uint8_t calc_bits;		//8, 16, 32 or 64
+extern bool calc_signed;
+extern uint8_t calc_status;
+
+void calc_set_word(uint8_t bits, bool is_signed);
+void calc_clear_status(void);
+calc_t calc_norm(calc_t value);
+
+char num_to_char(int n);
+int char_to_num(char c);
+calc_t convert(int system, const char *number);
+calc_t calc_digit(calc_t value, int system, uint8_t digit);
+calc_t calc_undigit(calc_t value, int system, uint8_t digit);	//calc_digit backwards, digit is the one dropped
+void convert_system(calc_t res, int system, char *out);	//system is 2, 8, 10 or 16
+calc_t calculate(calc_t a, calc_t b, char sign);	//+ - x / %, & | ^, < > shifts, L R rotates, ~ ignores b
+
+#endif /* CALCULATORFUNC_H_ */
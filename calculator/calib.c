@@ -0,0 +1,69 @@
+/*
+ * calib.c
+ * Touch calibration matrix from three target points (TI SLYT277).
+ */ 
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+#include <string.h>
+#include "calib.h"
+
+static const calib_t calib_default PROGMEM =	//the old fixed mapping, (x - 80) / 8 and (y - 80) / 6
+{
+	3, 0, -60,
+	0, 4, -80,
+	6,
+	CALIB_MAGIC
+};
+
+static calib_t EEMEM calib_stored;
+static calib_t calib;
+
+bool calib_load(void)							//false if EEPROM holds no calibration, the default is used then
+{
+	eeprom_read_block(&calib, &calib_stored, sizeof(calib_t));
+	
+	if (calib.magic == CALIB_MAGIC && calib.div != 0)
+	{
+		return true;
+	}
+	
+	memcpy_P(&calib, &calib_default, sizeof(calib_t));
+	return false;
+}
+
+void calib_apply(unsigned int raw_x, unsigned int raw_y, unsigned int *x, unsigned int *y)	//off screen results come out as large values
+{
+	int32_t rx = raw_x >> CALIB_SHIFT, ry = raw_y >> CALIB_SHIFT;
+	int32_t sx = (calib.a * rx + calib.b * ry + calib.c) / calib.div;
+	int32_t sy = (calib.d * rx + calib.e * ry + calib.f) / calib.div;
+	
+	*x = sx < 0 ? 0xffff : sx;
+	*y = sy < 0 ? 0xffff : sy;
+}
+
+bool calib_solve(const int16_t screen[3][2], const unsigned int raw[3][2])	//stores the new matrix, false if the points are collinear
+{
+	int32_t x0 = raw[0][0] >> CALIB_SHIFT, y0 = raw[0][1] >> CALIB_SHIFT;
+	int32_t x1 = raw[1][0] >> CALIB_SHIFT, y1 = raw[1][1] >> CALIB_SHIFT;
+	int32_t x2 = raw[2][0] >> CALIB_SHIFT, y2 = raw[2][1] >> CALIB_SHIFT;
+	int32_t sx0 = screen[0][0], sy0 = screen[0][1];
+	int32_t sx1 = screen[1][0], sy1 = screen[1][1];
+	int32_t sx2 = screen[2][0], sy2 = screen[2][1];
+	
+	calib.div = (x0 - x2) * (y1 - y2) - (x1 - x2) * (y0 - y2);
+	if (calib.div == 0)
+	{
+		return false;
+	}
+	
+	calib.a = (sx0 - sx2) * (y1 - y2) - (sx1 - sx2) * (y0 - y2);
+	calib.b = (x0 - x2) * (sx1 - sx2) - (sx0 - sx2) * (x1 - x2);
+	calib.c = y0 * (x2 * sx1 - x1 * sx2) + y1 * (x0 * sx2 - x2 * sx0) + y2 * (x1 * sx0 - x0 * sx1);
+	calib.d = (sy0 - sy2) * (y1 - y2) - (sy1 - sy2) * (y0 - y2);
+	calib.e = (x0 - x2) * (sy1 - sy2) - (sy0 - sy2) * (x1 - x2);
+	calib.f = y0 * (x2 * sy1 - x1 * sy2) + y1 * (x0 * sy2 - x2 * sy0) + y2 * (x1 * sy0 - x0 * sy1);
+	calib.magic = CALIB_MAGIC;
+	
+	eeprom_update_block(&calib, &calib_stored, sizeof(calib_t));
+	return true;
+}
@@ -0,0 +1,26 @@
+/*
+ * calib.h
+ * 3-point affine touch calibration, kept in EEPROM.
+ */ 
+#ifndef CALIB_H_
+#define CALIB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CALIB_SHIFT 2			//raw 12 bit readings are used as 10 bit, products stay in 32 bits
+#define CALIB_MAGIC 0xCA1B
+
+typedef struct
+{
+	int32_t a, b, c;			//screen x = (a * raw x + b * raw y + c) / div
+	int32_t d, e, f;			//screen y = (d * raw x + e * raw y + f) / div
+	int32_t div;
+	uint16_t magic;
+} calib_t;
+
+bool calib_load(void);
+void calib_apply(unsigned int raw_x, unsigned int raw_y, unsigned int *x, unsigned int *y);
+bool calib_solve(const int16_t screen[3][2], const unsigned int raw[3][2]);
+
+#endif /* CALIB_H_ */
@@ -0,0 +1,283 @@
+/*
+ * expr.c
+ * Tokens are compiled as they arrive. A number stays open while it is typed
+ * and is emitted when the next token closes it, so a keystroke only redoes
+ * the tail: the open number and the operators still waiting on the stack.
+ * Bytecode is one byte per item, BC_NUM | token index or the operator sign.
+ * Everything is static, no heap.
+ */ 
+#include <stdint.h>
+#include <stdbool.h>
+#include "expr.h"
+
+#define BC_NUM 0x80
+#define VALUE_STACK (EXPR_TOKENS / 2 + 1)	//numbers and operators alternate
+
+typedef struct
+{
+	uint8_t kind;
+	char op;					//for a number 'x' when the multiply in front of it is implicit, (a)b
+	calc_t value;
+} token_t;
+
+static token_t tok[EXPR_TOKENS];
+static uint8_t tok_cnt = 0;
+
+static uint8_t code[EXPR_TOKENS];		//every token emits at most one byte
+static uint8_t code_len = 0, pc = 0;	//pc is how far the VM got
+
+static char ops[EXPR_TOKENS];			//shunting-yard operator stack, '(' included
+static uint8_t ops_cnt = 0, depth = 0;
+
+static calc_t stack[VALUE_STACK];
+static char made_by[VALUE_STACK];		//operator that left each stack value, 0 for a number
+static uint8_t sp = 0;
+static char root = 0;					//made_by of what the last expr_value returned
+
+static uint8_t prec(char op)											//C order: x / %, + -, shifts and rotates, &, ^, |
+{
+	switch (op)
+	{
+		case 'x':
+		case '/':
+		case '%':
+			return 6;
+		case '+':
+		case '-':
+			return 5;
+		case '<':
+		case '>':
+		case 'L':
+		case 'R':
+			return 4;
+		case '&':
+			return 3;
+		case '^':
+			return 2;
+		case '|':
+			return 1;
+	}
+	return 0;															//'(' never gets popped by an operator
+}
+
+static void vm_run(void)												//execute what was emitted since the last run
+{
+	uint8_t bc;
+	
+	while (pc < code_len)
+	{
+		bc = code[pc++];
+		if (bc & BC_NUM)
+		{
+			made_by[sp] = 0;
+			stack[sp++] = calc_norm(tok[bc & ~BC_NUM].value);		//the word size may have changed since it was typed
+		}
+		else
+		{
+			sp--;
+			stack[sp - 1] = calculate(stack[sp - 1], stack[sp], bc);
+			made_by[sp - 1] = bc;
+		}
+	}
+}
+
+static void feed(uint8_t i)												//compile token i, the ones before it are done
+{
+	if (i && tok[i - 1].kind == TOK_NUM)								//the next token closes the number
+	{
+		code[code_len++] = BC_NUM | (i - 1);
+	}
+	
+	switch (tok[i].kind)
+	{
+		case TOK_OP:
+			while (ops_cnt && prec(ops[ops_cnt - 1]) >= prec(tok[i].op))	//left associative
+			{
+				code[code_len++] = ops[--ops_cnt];
+			}
+			ops[ops_cnt++] = tok[i].op;
+			break;
+		
+		case TOK_OPEN:
+			ops[ops_cnt++] = '(';
+			depth++;
+			break;
+		
+		case TOK_CLOSE:
+			while (ops[ops_cnt - 1] != '(')
+			{
+				code[code_len++] = ops[--ops_cnt];
+			}
+			ops_cnt--;
+			depth--;
+			break;
+	}
+	
+	vm_run();
+}
+
+static bool add(uint8_t kind, char op, calc_t value)
+{
+	if (tok_cnt == EXPR_TOKENS)
+	{
+		return false;
+	}
+	
+	tok[tok_cnt].kind = kind;
+	tok[tok_cnt].op = op;
+	tok[tok_cnt].value = value;
+	feed(tok_cnt++);
+	
+	return true;
+}
+
+static void recompile(uint8_t n)										//first n tokens again, after an edit behind what was emitted
+{
+	uint8_t i;
+	
+	expr_clear();
+	for (i = 0; i < n; i++)
+	{
+		tok_cnt++;
+		feed(i);
+	}
+}
+
+static uint8_t last_kind(void)
+{
+	return tok_cnt ? tok[tok_cnt - 1].kind : TOK_OPEN;					//an empty expression starts like a parenthesis
+}
+
+void expr_clear(void)
+{
+	tok_cnt = 0;
+	code_len = 0;
+	pc = 0;
+	ops_cnt = 0;
+	depth = 0;
+	sp = 0;
+}
+
+bool expr_empty(void)
+{
+	return tok_cnt == 0;
+}
+
+bool expr_number(calc_t value)
+{
+	if (last_kind() == TOK_NUM)											//still typing, nothing emitted yet
+	{
+		tok[tok_cnt - 1].value = value;
+		return true;
+	}
+	
+	if (last_kind() == TOK_CLOSE)										//(a)b is (a)xb
+	{
+		if (!expr_op('x'))
+		{
+			return false;
+		}
+		if (!add(TOK_NUM, 'x', value))									//no room for the number, no dangling x either
+		{
+			recompile(tok_cnt - 1);
+			return false;
+		}
+		return true;
+	}
+	
+	return add(TOK_NUM, 0, value);
+}
+
+void expr_unnumber(void)
+{
+	if (last_kind() != TOK_NUM)
+	{
+		return;
+	}
+	
+	if (tok[--tok_cnt].op)												//its implicit x goes too, it may have popped others
+	{
+		recompile(tok_cnt - 1);
+	}
+}
+
+bool expr_op(char op)
+{
+	if (last_kind() == TOK_OP)											//replace, recompile since the first one may have popped others
+	{
+		tok[tok_cnt - 1].op = op;
+		recompile(tok_cnt);
+		return true;
+	}
+	
+	if (last_kind() == TOK_OPEN && !add(TOK_NUM, 0, 0))					//(-a is (0-a
+	{
+		return false;
+	}
+	
+	return add(TOK_OP, op, 0);
+}
+
+bool expr_open(void)
+{
+	if ((last_kind() == TOK_NUM || last_kind() == TOK_CLOSE) && !expr_op('x'))	//a(b) is ax(b)
+	{
+		return false;
+	}
+	
+	return add(TOK_OPEN, '(', 0);
+}
+
+bool expr_close(void)
+{
+	if (!depth || (last_kind() != TOK_NUM && last_kind() != TOK_CLOSE))
+	{
+		return false;
+	}
+	
+	return add(TOK_CLOSE, ')', 0);
+}
+
+calc_t expr_value(void)													//finish on a copy, the compiled part stays as it is
+{
+	calc_t v[VALUE_STACK];
+	char m[VALUE_STACK];
+	uint8_t n = sp, o = ops_cnt, i;
+	bool dangling = last_kind() != TOK_NUM && last_kind() != TOK_CLOSE;	//the innermost operator has no right operand yet
+	
+	for (i = 0; i < sp; i++)
+	{
+		v[i] = stack[i];
+		m[i] = made_by[i];
+	}
+	
+	if (last_kind() == TOK_NUM)
+	{
+		m[n] = 0;
+		v[n++] = calc_norm(tok[tok_cnt - 1].value);
+	}
+	
+	while (o--)
+	{
+		if (ops[o] == '(')
+		{
+			continue;
+		}
+		if (dangling || n < 2)
+		{
+			dangling = false;
+			continue;
+		}
+		n--;
+		v[n - 1] = calculate(v[n - 1], v[n], ops[o]);
+		m[n - 1] = ops[o];
+	}
+	
+	root = n ? m[n - 1] : 0;
+	return n ? v[n - 1] : 0;
+}
+
+char expr_root(void)
+{
+	return root;
+}
@@ -0,0 +1,32 @@
+/*
+ * expr.h
+ * Infix expression engine: tokens from the keypad, shunting-yard into RPN
+ * bytecode, run by a small stack VM as the code is emitted.
+ */ 
+#ifndef EXPR_H_
+#define EXPR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "calculatorFunc.h"
+
+#define EXPR_TOKENS 24			//numbers, operators and parentheses in one expression
+
+/*token kinds*/
+#define TOK_NUM 0
+#define TOK_OP 1
+#define TOK_OPEN 2
+#define TOK_CLOSE 3
+/*end token kinds*/
+
+void expr_clear(void);
+bool expr_empty(void);
+bool expr_number(calc_t value);		//sets the number being typed, starts a new one after an operator
+void expr_unnumber(void);			//takes the number being typed back out, backspace past its first digit
+bool expr_op(char op);				//a second operator in a row replaces the first
+bool expr_open(void);
+bool expr_close(void);
+calc_t expr_value(void);			//value so far, open parentheses and a trailing operator are left out
+char expr_root(void);				//operator applied last for that value, 5-2+1 gives '+', 0 for a lone number
+
+#endif /* EXPR_H_ */
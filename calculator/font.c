@@ -1,4 +1,6 @@
-static const unsigned char font[96][5] =
+#include <avr/pgmspace.h>
+
+static const unsigned char font[96][5] PROGMEM =
 {
      {0x00, 0x00, 0x00, 0x00, 0x00} // 20
     ,{0x00, 0x00, 0x5F, 0x00, 0x00} // 21 !
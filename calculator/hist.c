@@ -0,0 +1,209 @@
+/*
+ * hist.c
+ * EEPROM log behind hist.h. A record is only taken as valid when its check
+ * byte matches, so a slot cut off by a power loss or never written is skipped
+ * and the record before it stays the newest.
+ */ 
+#include <avr/eeprom.h>
+#include <stddef.h>
+#include <string.h>
+#include "hist.h"
+
+#define HIST_CHECK_SEED 0xA5	//neither erased (0xff) nor cleared EEPROM passes the check
+
+typedef struct
+{
+	uint8_t seq;				//one more than the record before, wraps
+	uint8_t flags;
+	hist_state_t state;
+	uint8_t check;				//written last
+} hist_rec_t;
+
+static hist_rec_t EEMEM hist_log[HIST_SLOTS];
+
+static hist_rec_t pending;					//newest state, not written yet
+static bool pending_set = false;
+static hist_rec_t after;					//state saved over a queued answer, queued behind it
+static bool after_set = false;
+static hist_rec_t out;						//record going out, pending may change meanwhile
+static uint8_t out_pos = sizeof(hist_rec_t);	//next byte of out, sizeof when nothing is going out
+static uint8_t head = 0;					//slot out goes to
+static uint8_t seq = 0;
+
+static hist_entry_t recent[HIST_KEEP];		//newest first
+static uint8_t recent_cnt = 0;
+
+static uint8_t hist_check(const hist_rec_t *rec)
+{
+	const uint8_t *p = (const uint8_t *)rec;
+	uint8_t i, c = HIST_CHECK_SEED;
+	
+	for (i = 0; i < offsetof(hist_rec_t, check); i++)
+	{
+		c = ((c << 1) | (c >> 7)) ^ p[i];
+	}
+	return c;
+}
+
+static void entry_of(const hist_state_t *state, hist_entry_t *entry)
+{
+	entry->value = state->value;
+	entry->base = state->base;
+	entry->op = state->op;
+}
+
+static void recent_insert(uint8_t i, const hist_state_t *state)	//at position i, older ones move down
+{
+	memmove(&recent[i + 1], &recent[i], (HIST_KEEP - 1 - i) * sizeof(hist_entry_t));
+	entry_of(state, &recent[i]);
+	if (recent_cnt < HIST_KEEP)
+	{
+		recent_cnt++;
+	}
+}
+
+bool hist_load(hist_state_t *state)
+{
+	hist_rec_t rec;
+	uint8_t recent_seq[HIST_KEEP];
+	uint8_t i, k, newest = 0;
+	bool found = false;
+	
+	recent_cnt = 0;
+	for (i = 0; i < HIST_SLOTS; i++)
+	{
+		eeprom_read_block(&rec, &hist_log[i], sizeof(hist_rec_t));
+		if (rec.check != hist_check(&rec))
+		{
+			continue;
+		}
+		
+		if (!found || (int8_t)(rec.seq - seq) > 0)					//all live records are less than a ring apart
+		{
+			found = true;
+			newest = i;
+			seq = rec.seq;
+			*state = rec.state;
+		}
+		
+		if (rec.flags & HIST_RESULT)									//kept sorted by sequence, newest first
+		{
+			for (k = 0; k < recent_cnt && (int8_t)(rec.seq - recent_seq[k]) < 0; k++);
+			if (k < HIST_KEEP)
+			{
+				memmove(&recent_seq[k + 1], &recent_seq[k], HIST_KEEP - 1 - k);
+				recent_seq[k] = rec.seq;
+				recent_insert(k, &rec.state);
+			}
+		}
+	}
+	
+	if (found)
+	{
+		head = (newest + 1) % HIST_SLOTS;
+		seq++;
+	}
+	return found;
+}
+
+void hist_save(const hist_state_t *state, bool result)
+{
+	if (!result && pending_set && (pending.flags & HIST_RESULT))		//the answer still goes to the log, the state after it
+	{
+		after.flags = 0;
+		after.state = *state;
+		after_set = true;
+		return;
+	}
+	
+	after_set = false;													//a newer state or answer replaces it
+	if (!pending_set)
+	{
+		pending.flags = 0;
+	}
+	pending.state = *state;
+	if (result)														//two answers before a write: only the later one reaches the log
+	{
+		pending.flags |= HIST_RESULT;
+		recent_insert(0, state);
+	}
+	pending_set = true;
+}
+
+bool hist_get(uint8_t i, hist_entry_t *entry)
+{
+	if (i >= recent_cnt)
+	{
+		return false;
+	}
+	*entry = recent[i];
+	return true;
+}
+
+bool hist_read(uint8_t i, hist_entry_t *entry)							//queued record, the one going out, then the newest slot backwards until the sequence breaks
+{
+	hist_rec_t rec;
+	uint8_t k, expect = seq;
+	
+	if (pending_set && (pending.flags & HIST_RESULT) && i-- == 0)
+	{
+		entry_of(&pending.state, entry);
+		return true;
+	}
+	if (out_pos < sizeof(hist_rec_t))									//its slot is half written, the copy is whole
+	{
+		if ((out.flags & HIST_RESULT) && i-- == 0)
+		{
+			entry_of(&out.state, entry);
+			return true;
+		}
+		expect = out.seq;
+	}
+	
+	for (k = 1; k <= HIST_SLOTS; k++)
+	{
+		eeprom_read_block(&rec, &hist_log[(head + HIST_SLOTS - k) % HIST_SLOTS], sizeof(hist_rec_t));
+		if (rec.check != hist_check(&rec) || rec.seq != (uint8_t)(expect - 1))
+		{
+			break;
+		}
+		expect = rec.seq;
+		
+		if ((rec.flags & HIST_RESULT) && i-- == 0)
+		{
+			entry_of(&rec.state, entry);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool hist_poll(void)													//one byte per call, the EEPROM takes about 8.5 ms over it on its own
+{
+	if (!eeprom_is_ready())
+	{
+		return true;
+	}
+	
+	if (out_pos == sizeof(hist_rec_t))
+	{
+		if (!pending_set)
+		{
+			return false;
+		}
+		out = pending;
+		out.seq = seq++;
+		out.check = hist_check(&out);
+		pending = after;
+		pending_set = after_set;
+		after_set = false;
+		out_pos = 0;
+	}
+	
+	eeprom_update_byte((uint8_t *)&hist_log[head] + out_pos, ((uint8_t *)&out)[out_pos]);	//unchanged bytes cost no write cycle
+	if (++out_pos == sizeof(hist_rec_t))
+	{
+		head = (head + 1) % HIST_SLOTS;
+	}
+	return true;
+}
@@ -0,0 +1,44 @@
+/*
+ * hist.h
+ * Results history and the M register, kept in EEPROM as a log of state
+ * records. Every save goes to the next slot of a ring, so wear is spread
+ * over all slots, and boot takes the record with the newest sequence number.
+ * Records are written a byte at a time from the idle loop, never from a key.
+ */ 
+#ifndef HIST_H_
+#define HIST_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "calculatorFunc.h"
+
+#define HIST_SLOTS 36			//records in the EEPROM ring, under 128 so 8 bit sequence numbers still order them
+#define HIST_KEEP 8				//results that can be recalled
+
+/*record flags*/
+#define HIST_RESULT 0x01		//the record's value is an answer, it goes into the history
+/*end record flags*/
+
+typedef struct
+{
+	calc_t value;				//number shown
+	calc_t memory;				//M register
+	uint8_t base, bits;
+	bool is_signed;
+	char op;					//operator the answer came from, expr_root, 0 if none
+} hist_state_t;
+
+typedef struct
+{
+	calc_t value;
+	uint8_t base;
+	char op;
+} hist_entry_t;
+
+bool hist_load(hist_state_t *state);						//one pass over the log, false if it holds nothing
+void hist_save(const hist_state_t *state, bool result);		//queues the state, replaces one not written yet
+bool hist_get(uint8_t i, hist_entry_t *entry);				//i-th result back, 0 is the newest
+bool hist_read(uint8_t i, hist_entry_t *entry);				//same from the log, as far back as the ring goes, records not written yet included
+bool hist_poll(void);										//next byte of the queued record when the EEPROM is free, false once all are out
+
+#endif /* HIST_H_ */
@@ -0,0 +1,124 @@
+/*
+ * input.c
+ * Debounce and auto-repeat state machine, one step per timer tick.
+ */ 
+#include <stdint.h>
+#include <stdbool.h>
+#include "input.h"
+#include "touch.h"
+#include "prof.h"
+
+/*debounce states*/
+#define IN_IDLE 0
+#define IN_DEBOUNCE 1
+#define IN_HELD 2
+#define IN_REPEAT 3
+#define IN_RELEASE 4
+/*end debounce states*/
+
+static volatile touch_event_t queue[EVENT_QUEUE];	//volatile too, so the entry is read after head and written before it
+static volatile uint8_t head = 0, tail = 0;	//head written by the tick only, tail by the UI loop only
+
+static uint8_t state = IN_IDLE;
+static uint16_t ticks = 0;
+
+static void input_capture(uint8_t type)		//read the position while the pen is still down
+{
+	uint8_t next = (head + 1) & (EVENT_QUEUE - 1);
+	
+	if (next == tail)						//queue full, the press is dropped rather than blocking the tick
+	{
+		return;
+	}
+	
+	bool pressed;
+	
+	PROF_BEGIN(TOUCH_READ);
+	pressed = touch_read_xy();
+	PROF_END(TOUCH_READ);
+	
+	if (!pressed)							//too light, no event
+	{
+		return;
+	}
+	
+	queue[head].type = type;
+	queue[head].x = T_X;
+	queue[head].y = T_Y;
+	head = next;
+}
+
+void input_tick(void)
+{
+	bool down = touch_pressed();
+	
+	switch (state)
+	{
+		case IN_IDLE:
+			if (down)
+			{
+				state = IN_DEBOUNCE;
+				ticks = 0;
+			}
+			break;
+		
+		case IN_DEBOUNCE:
+			if (!down)
+			{
+				state = IN_IDLE;
+			}
+			else if (++ticks >= DEBOUNCE_TICKS)
+			{
+				input_capture(EVENT_PRESS);
+				state = IN_HELD;
+				ticks = 0;
+			}
+			break;
+		
+		case IN_HELD:
+		case IN_REPEAT:
+			if (!down)
+			{
+				state = IN_RELEASE;
+				ticks = 0;
+			}
+			else if (++ticks >= (state == IN_HELD ? REPEAT_DELAY_TICKS : REPEAT_RATE_TICKS))
+			{
+				input_capture(EVENT_REPEAT);
+				state = IN_REPEAT;
+				ticks = 0;
+			}
+			break;
+		
+		case IN_RELEASE:
+			if (down)								//bounce on release, still the same press
+			{
+				state = IN_HELD;
+				ticks = 0;
+			}
+			else if (++ticks >= DEBOUNCE_TICKS)
+			{
+				state = IN_IDLE;
+			}
+			break;
+	}
+}
+
+bool input_pending(void)
+{
+	return head != tail;
+}
+
+bool input_pop(touch_event_t *ev)
+{
+	if (head == tail)
+	{
+		return false;
+	}
+	
+	ev->type = queue[tail].type;
+	ev->x = queue[tail].x;
+	ev->y = queue[tail].y;
+	tail = (tail + 1) & (EVENT_QUEUE - 1);
+	return true;
+}
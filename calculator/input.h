@@ -0,0 +1,36 @@
+/*
+ * input.h
+ * Debounced touch events, queued from the timer tick and consumed by the UI loop.
+ */ 
+#ifndef INPUT_H_
+#define INPUT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TICK_HZ 1000			//input_tick rate
+
+/*debounce timing, in ticks*/
+#define DEBOUNCE_TICKS 10
+#define REPEAT_DELAY_TICKS 500
+#define REPEAT_RATE_TICKS 100
+/*end debounce*/
+
+#define EVENT_QUEUE 8			//power of two
+
+/*event types*/
+#define EVENT_PRESS 0
+#define EVENT_REPEAT 1
+/*end event types*/
+
+typedef struct
+{
+	uint8_t type;
+	unsigned int x, y;			//raw touch reading
+} touch_event_t;
+
+void input_tick(void);
+bool input_pending(void);
+bool input_pop(touch_event_t *ev);
+
+#endif /* INPUT_H_ */
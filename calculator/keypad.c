@@ -0,0 +1,160 @@
+#include <avr/pgmspace.h>
+#include <stdint.h>
+
+/*key actions*/
+#define KEY_DIGIT 0
+#define KEY_OP 1
+#define KEY_EQUALS 2
+#define KEY_CLEAR 3
+#define KEY_BASE 4
+#define KEY_PAREN 5
+#define KEY_WORD 6
+#define KEY_NOT 7
+#define KEY_PAGE 8
+#define KEY_MEM 9
+#define KEY_HIST 10
+#define KEY_SIGN 11
+#define KEY_DELETE 12
+#define KEY_NONE 0xff
+/*end key actions*/
+
+typedef struct
+{
+	uint8_t x, w;		//key rect, x is below MAX_X so a byte is enough
+	uint16_t y;
+	uint8_t h;
+	char label[4];
+	uint8_t min_base;	//key only works in this base or higher
+	uint8_t action;
+	char value;			//digit, operator sign or base
+} button_t;
+
+typedef struct
+{
+	uint16_t y;			//top of the band
+	uint8_t h;			//row height
+	uint8_t w;			//key width
+	uint8_t cols, rows;
+	uint8_t first;		//index of the band's first key in keys[]
+	uint8_t pages;		//key sets the band switches between, each cols * rows long
+	uint8_t font_size, label_x, label_y;	//label offset inside a key
+} band_t;
+
+/*layout*/
+#define MENU_Y 0
+#define MENU_H 40
+#define MENU_W 40
+#define PAD_Y 100
+#define PAD_H 35
+#define PAD_W 60
+#define HEX_Y (PAD_Y + 5 * PAD_H)
+#define HEX_H 45
+#define HEX_W 40
+#define PAD_PAGES 3		//FN steps through them
+
+#define MENU_KEY(col) (col) * MENU_W, MENU_W, MENU_Y, MENU_H
+#define PAD_KEY(col, row) (col) * PAD_W, PAD_W, PAD_Y + (row) * PAD_H, PAD_H
+#define HEX_KEY(col) (col) * HEX_W, HEX_W, HEX_Y, HEX_H
+/*end layout*/
+
+static const band_t bands[] PROGMEM =
+{
+	 {MENU_Y, MENU_H, MENU_W, 6, 1, 0, 1, 2, 2, 12}		//base menu and parentheses
+	,{PAD_Y, PAD_H, PAD_W, 4, 5, 6, PAD_PAGES, 3, 20, 6}	//digits and operators, FN steps to the programmer and memory pages
+	,{HEX_Y, HEX_H, HEX_W, 6, 1, 66, 1, 3, 20, 10}		//A-F
+};
+
+#define BAND_CNT (sizeof(bands) / sizeof(bands[0]))
+
+//bands are filled row by row from x = 0, the display is mirrored so that is the right edge
+static const button_t keys[] PROGMEM =
+{
+	 {MENU_KEY(0), "HEX", 0, KEY_BASE, 16}
+	,{MENU_KEY(1), "DEC", 0, KEY_BASE, 10}
+	,{MENU_KEY(2), "OCT", 0, KEY_BASE, 8}
+	,{MENU_KEY(3), "BIN", 0, KEY_BASE, 2}
+	,{MENU_KEY(4), " ) ", 0, KEY_PAREN, ')'}
+	,{MENU_KEY(5), " ( ", 0, KEY_PAREN, '('}
+	
+	,{PAD_KEY(0, 0), "/", 0, KEY_OP, '/'}
+	,{PAD_KEY(1, 0), "9", 10, KEY_DIGIT, '9'}
+	,{PAD_KEY(2, 0), "8", 10, KEY_DIGIT, '8'}
+	,{PAD_KEY(3, 0), "7", 8, KEY_DIGIT, '7'}
+	
+	,{PAD_KEY(0, 1), "x", 0, KEY_OP, 'x'}
+	,{PAD_KEY(1, 1), "6", 8, KEY_DIGIT, '6'}
+	,{PAD_KEY(2, 1), "5", 8, KEY_DIGIT, '5'}
+	,{PAD_KEY(3, 1), "4", 8, KEY_DIGIT, '4'}
+	
+	,{PAD_KEY(0, 2), "+", 0, KEY_OP, '+'}
+	,{PAD_KEY(1, 2), "3", 8, KEY_DIGIT, '3'}
+	,{PAD_KEY(2, 2), "2", 8, KEY_DIGIT, '2'}
+	,{PAD_KEY(3, 2), "1", 2, KEY_DIGIT, '1'}
+	
+	,{PAD_KEY(0, 3), "-", 0, KEY_OP, '-'}
+	,{PAD_KEY(1, 3), "=", 0, KEY_EQUALS, '='}
+	,{PAD_KEY(2, 3), "CLR", 0, KEY_CLEAR, 0}
+	,{PAD_KEY(3, 3), "0", 2, KEY_DIGIT, '0'}
+	
+	,{PAD_KEY(0, 4), "MOD", 0, KEY_OP, '%'}
+	,{PAD_KEY(1, 4), "DEL", 0, KEY_DELETE, 0}
+	,{PAD_KEY(2, 4), "AND", 0, KEY_OP, '&'}
+	,{PAD_KEY(3, 4), "FN", 0, KEY_PAGE, 0}
+	
+	,{PAD_KEY(0, 0), "/", 0, KEY_OP, '/'}					//programmer page
+	,{PAD_KEY(1, 0), "ROL", 0, KEY_OP, 'L'}
+	,{PAD_KEY(2, 0), "SHR", 0, KEY_OP, '>'}
+	,{PAD_KEY(3, 0), "SHL", 0, KEY_OP, '<'}
+	
+	,{PAD_KEY(0, 1), "x", 0, KEY_OP, 'x'}
+	,{PAD_KEY(1, 1), "XOR", 0, KEY_OP, '^'}
+	,{PAD_KEY(2, 1), "OR", 0, KEY_OP, '|'}
+	,{PAD_KEY(3, 1), "AND", 0, KEY_OP, '&'}
+	
+	,{PAD_KEY(0, 2), "+", 0, KEY_OP, '+'}
+	,{PAD_KEY(1, 2), "32", 0, KEY_WORD, 32}
+	,{PAD_KEY(2, 2), "16", 0, KEY_WORD, 16}
+	,{PAD_KEY(3, 2), "8", 0, KEY_WORD, 8}
+	
+	,{PAD_KEY(0, 3), "-", 0, KEY_OP, '-'}
+	,{PAD_KEY(1, 3), "=", 0, KEY_EQUALS, '='}
+	,{PAD_KEY(2, 3), "CLR", 0, KEY_CLEAR, 0}
+	,{PAD_KEY(3, 3), "64", 0, KEY_WORD, 64}
+	
+	,{PAD_KEY(0, 4), "S/U", 0, KEY_SIGN, 0}
+	,{PAD_KEY(1, 4), "NOT", 0, KEY_NOT, '~'}
+	,{PAD_KEY(2, 4), "ROR", 0, KEY_OP, 'R'}
+	,{PAD_KEY(3, 4), "FN", 0, KEY_PAGE, 0}
+	
+	,{PAD_KEY(0, 0), "/", 0, KEY_OP, '/'}					//memory page, the bottom rows stay as on the first
+	,{PAD_KEY(1, 0), "MR", 0, KEY_MEM, 'R'}
+	,{PAD_KEY(2, 0), "M-", 0, KEY_MEM, '-'}
+	,{PAD_KEY(3, 0), "M+", 0, KEY_MEM, '+'}
+	
+	,{PAD_KEY(0, 1), "x", 0, KEY_OP, 'x'}
+	,{PAD_KEY(1, 1), "NXT", 0, KEY_HIST, '>'}
+	,{PAD_KEY(2, 1), "PRV", 0, KEY_HIST, '<'}
+	,{PAD_KEY(3, 1), "MC", 0, KEY_MEM, 'C'}
+	
+	,{PAD_KEY(0, 2), "+", 0, KEY_OP, '+'}
+	,{PAD_KEY(1, 2), "3", 8, KEY_DIGIT, '3'}
+	,{PAD_KEY(2, 2), "2", 8, KEY_DIGIT, '2'}
+	,{PAD_KEY(3, 2), "1", 2, KEY_DIGIT, '1'}
+	
+	,{PAD_KEY(0, 3), "-", 0, KEY_OP, '-'}
+	,{PAD_KEY(1, 3), "=", 0, KEY_EQUALS, '='}
+	,{PAD_KEY(2, 3), "CLR", 0, KEY_CLEAR, 0}
+	,{PAD_KEY(3, 3), "0", 2, KEY_DIGIT, '0'}
+	
+	,{PAD_KEY(0, 4), "MOD", 0, KEY_OP, '%'}
+	,{PAD_KEY(1, 4), "DEL", 0, KEY_DELETE, 0}
+	,{PAD_KEY(2, 4), "AND", 0, KEY_OP, '&'}
+	,{PAD_KEY(3, 4), "FN", 0, KEY_PAGE, 0}
+	
+	,{HEX_KEY(0), "F", 16, KEY_DIGIT, 'F'}
+	,{HEX_KEY(1), "E", 16, KEY_DIGIT, 'E'}
+	,{HEX_KEY(2), "D", 16, KEY_DIGIT, 'D'}
+	,{HEX_KEY(3), "C", 16, KEY_DIGIT, 'C'}
+	,{HEX_KEY(4), "B", 16, KEY_DIGIT, 'B'}
+	,{HEX_KEY(5), "A", 16, KEY_DIGIT, 'A'}
+};
@@ -0,0 +1,145 @@
+/*
+ * lcd.c
+ * 16 bit 8080 style bus to the SSD1289 controller.
+ */ 
+#ifndef F_CPU
+#define F_CPU 7372800UL
+#endif
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <stdint.h>
+#include "lcd.h"
+
+void LCD_reset(void)							//port directions and the reset pulse
+{
+	DDRA = 0xff;
+	DDRB = 0xff;
+	DDRC = 0xff;
+	DDRD |= _BV(LCD_RESET);
+	
+	PORTD &= ~_BV(LCD_RESET);
+	_delay_ms(10);
+	PORTD |= _BV(LCD_RESET);
+	PORTC |= _BV(LCD_CS);
+	PORTC |= _BV(LCD_RD);
+	PORTC &= ~_BV(LCD_WR);
+	_delay_ms(20);
+}
+
+void LCD_write_cmd(int  DH)	
+{
+	PORTC &= ~_BV(LCD_RS);
+	PORTC &= ~_BV(LCD_CS);
+	LCD_DataHigh = DH >> 8;
+	LCD_DataLow = DH;
+	PORTC |= _BV(LCD_WR);
+	PORTC &= ~_BV(LCD_WR);
+	PORTC |= _BV(LCD_CS);	
+}
+
+void LCD_write_color(char hh, char ll)	
+{
+	PORTC |= _BV(LCD_RS);
+	PORTC &= ~_BV(LCD_CS);
+	LCD_DataHigh = hh;
+	LCD_DataLow = ll;
+	PORTC |= _BV(LCD_WR);
+	PORTC &= ~_BV(LCD_WR);
+	PORTC |= _BV(LCD_CS);
+}
+
+void LCD_write_data(int DH)	
+{
+	PORTC |= _BV(LCD_RS);
+	PORTC &= ~_BV(LCD_CS);
+	LCD_DataHigh = DH >> 8;
+	LCD_DataLow = DH;
+	PORTC |= _BV(LCD_WR);
+	PORTC &= ~_BV(LCD_WR);
+	PORTC |= _BV(LCD_CS);
+}
+
+
+void LCD_burst_begin(void)						//RS and CS stay set for a whole pixel burst
+{
+	PORTC |= _BV(LCD_RS);
+	PORTC &= ~_BV(LCD_CS);
+}
+
+void LCD_burst_pixel(unsigned int colour)
+{
+	LCD_DataHigh = colour >> 8;
+	LCD_DataLow = colour;
+	PORTC |= _BV(LCD_WR);
+	PORTC &= ~_BV(LCD_WR);
+}
+
+void LCD_burst_end(void)
+{
+	PORTC |= _BV(LCD_CS);
+}
+
+void LCD_burst_fill(unsigned int colour, unsigned long count)	//colour is latched once, then only WR is strobed
+{
+	uint8_t wr_high, wr_low;
+	unsigned int blocks = count >> 3;
+	uint8_t rest = count & 0x07;
+	
+	LCD_burst_begin();
+	LCD_DataHigh = colour >> 8;
+	LCD_DataLow = colour;
+	wr_high = PORTC | _BV(LCD_WR);
+	wr_low = PORTC & ~_BV(LCD_WR);
+	
+	while (blocks--)							//8 pixels per pass keeps loop overhead off the strobe
+	{
+		PORTC = wr_high; PORTC = wr_low;
+		PORTC = wr_high; PORTC = wr_low;
+		PORTC = wr_high; PORTC = wr_low;
+		PORTC = wr_high; PORTC = wr_low;
+		PORTC = wr_high; PORTC = wr_low;
+		PORTC = wr_high; PORTC = wr_low;
+		PORTC = wr_high; PORTC = wr_low;
+		PORTC = wr_high; PORTC = wr_low;
+	}
+	while (rest--)
+	{
+		PORTC = wr_high; PORTC = wr_low;
+	}
+	
+	LCD_burst_end();
+}
+
+void LCD_read_begin(void)						//after the 0x22 index write, the bus turns around and the first word out is a dummy
+{
+	LCD_DataHigh = 0x00;						//no pull-ups against the controller
+	LCD_DataLow = 0x00;
+	DDRA = 0x00;
+	DDRB = 0x00;
+	PORTC |= _BV(LCD_RS);
+	PORTC &= ~_BV(LCD_CS);
+	LCD_read_pixel();
+}
+
+unsigned int LCD_read_pixel(void)
+{
+	unsigned int colour;
+	
+	cli();										//the touch tick can drive PB4-PB7, not while the controller does
+	PORTC &= ~_BV(LCD_RD);
+	_delay_us(0.5);								//read access time, longer than the write strobe needs
+	colour = (PINB << 8) | PINA;
+	PORTC |= _BV(LCD_RD);
+	sei();
+	
+	return colour;
+}
+
+void LCD_read_end(void)
+{
+	PORTC |= _BV(LCD_CS);
+	DDRA = 0xff;
+	DDRB = 0xff;
+}
@@ -0,0 +1,32 @@
+/*
+ * lcd.h
+ * LCD bus on PORTA-PORTC, the layer main.c draws and reads GRAM back through.
+ */ 
+#ifndef LCD_H_
+#define LCD_H_
+
+/*display config*/
+#define LCD_DataLow PORTA	// data pins D0-D7
+#define LCD_DataHigh PORTB  // data pins D8-D15
+
+#define LCD_RS PC0	//register select pin - choose instruction/character mode
+#define LCD_CS PC7	//chip select pin
+#define LCD_RD PC6	//read data
+#define LCD_WR PC1	//write data
+
+#define LCD_RESET PD7	//display reset
+/*end display*/
+
+void LCD_reset(void);
+void LCD_write_cmd(int DH);
+void LCD_write_color(char hh, char ll);
+void LCD_write_data(int DH);
+void LCD_burst_begin(void);
+void LCD_burst_pixel(unsigned int colour);
+void LCD_burst_end(void);
+void LCD_burst_fill(unsigned int colour, unsigned long count);
+void LCD_read_begin(void);
+unsigned int LCD_read_pixel(void);		//GRAM word at the address counter, which then steps as on a write
+void LCD_read_end(void);
+
+#endif /* LCD_H_ */
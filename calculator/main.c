@@ -9,137 +9,35 @@
 #define WHITE 0xffff
 #define RED 0xD369
 
-#include <avr/io.h>
 #include <util/delay.h>
-#include <avr/cpufunc.h>
+#include <avr/pgmspace.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
 #include <string.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
 #include "font.c"		
+#include "keypad.c"
+#include "lcd.h"
+#include "touch.h"
+#include "input.h"
+#include "calib.h"
+#include "calculatorFunc.h"
+#include "expr.h"
+#include "prof.h"
+#include "serial.h"
+#include "batch.h"
+#include "hist.h"
+#include "sched.h"
 
-/*display config*/
-#define LCD_DataLow PORTA	// data pins D0-D7
-#define LCD_DataHigh PORTB  // data pins D8-D15
-
-#define LCD_RS PC0	//register select pin - choose instruction/character mode
-#define LCD_CS PC7	//chip select pin
-#define LCD_RD PC6	//read data
-#define LCD_WR PC1	//write data
-
-#define LCD_RESET PD7	//display reset
-/*end display*/
-
-/*touch config*/
-#define T_IRQ PD0	//1 if screen is touched
-#define T_OUT PD3	//get data from touch (serial)
-#define T_IN PD6	//send data (x, y coordinate) to touch
-#define T_CLK PD1   //touch controller clock
-#define T_CS PD2	//touch chip select
-/*end touch*/
 #define BLANK "_______"
 #define MAX_CHARS 16
 
-unsigned int T_X, T_Y;			//x and y coordinates
-char number_1[MAX_CHARS + 1] = BLANK;	//number that is being written
-int number_1_mem = 0;			//written number, save it for later use
-char tmp[MAX_CHARS + 1] = BLANK;		//number in memory
-
-bool getBit(int reg, int offset) {
-	return !!( (reg >> offset) & 1 );
-}
-
-void touch_start() {
-	PORTD |= _BV(T_CS) | _BV(T_CLK) | _BV(T_IN);       
-}
-
-void touch_write(unsigned char num) {	
-	int count = 0;
-	PORTD &= ~_BV(T_CLK);
-	for(count = 7; count >= 0; count--){
-		
-		if ( getBit(num,count) ) {
-			PORTD |= _BV(T_IN);
-			} else {
-			PORTD &= ~_BV(T_IN);
-		}
-		PORTD &= ~_BV(T_CLK);
-		PORTD |= _BV(T_CLK);
-	}
-}
-
-unsigned int touch_read_char() {						//read data from ADC (touch) 
-	unsigned char count = 0;
-	unsigned int Num = 0;
-	
-	for(count = 0; count < 12; count++){
-		Num <<= 1;
-		PORTD |= _BV(T_CLK);					//high signal to T_CLK
-		PORTD &= ~_BV(T_CLK);					//low signal to T_CLK - initialize data transfer (from datasheet)
-		Num += getBit(PIND, T_OUT);				//touch ADC - 12 bits, get 1bit at a time from T_OUT
-	}
-	
-	return Num;
-}
-
-void touch_read_xy(void)													//touch read x, y coordinate
-{
-	_delay_ms(1);
-	PORTD &= ~_BV(T_CS);													//to start transmission, CS is set to low
-	
-	touch_write(0x90);       	                                            //send command to touch to get ready to write y coordinate
-	_delay_ms(1);
-	PORTD |= _BV(T_CLK); 
-	_NOP();  _NOP();  _NOP();  _NOP();										//do nothing, delay for next instruction
-	PORTD &= ~_BV(T_CLK); 
-	_NOP();  _NOP();  _NOP();  _NOP();
-	T_Y = touch_read_char();
-	
-	touch_write(0xD0);														//send command to touch to get ready to write x coordinate
-	PORTD |= _BV(T_CLK); 
-	_NOP();  _NOP();  _NOP();  _NOP();
-	PORTD &= ~_BV(T_CLK); 
-	_NOP();  _NOP();  _NOP();  _NOP();
-	T_X = touch_read_char();
-	
-	PORTD |= _BV(T_CS);														//to end transmission, CS is set to high
-}
-
-
-void LCD_write_cmd(int  DH)	
-{
-	PORTC &= ~_BV(LCD_RS);
-	PORTC &= ~_BV(LCD_CS);
-	LCD_DataHigh = DH >> 8;
-	LCD_DataLow = DH;
-	PORTC |= _BV(LCD_WR);
-	PORTC &= ~_BV(LCD_WR);
-	PORTC |= _BV(LCD_CS);	
-}
-
-void LCD_write_color(char hh, char ll)	
-{
-	PORTC |= _BV(LCD_RS);
-	PORTC &= ~_BV(LCD_CS);
-	LCD_DataHigh = hh;
-	LCD_DataLow = ll;
-	PORTC |= _BV(LCD_WR);
-	PORTC &= ~_BV(LCD_WR);
-	PORTC |= _BV(LCD_CS);
-}
-
-void LCD_write_data(int DH)	
-{
-	PORTC |= _BV(LCD_RS);
-	PORTC &= ~_BV(LCD_CS);
-	LCD_DataHigh = DH >> 8;
-	LCD_DataLow = DH;
-	PORTC |= _BV(LCD_WR);
-	PORTC &= ~_BV(LCD_WR);
-	PORTC |= _BV(LCD_CS);
-}
-
+char number_1[NUM_CHARS + 1] = BLANK;	//number that is being written
+char result_shown[MAX_CHARS];			//what is on the result line now, cell 0 is the last digit
+uint8_t key_page = 0;					//page shown on bands that have more than one
 
 void LCD_write_cmd_data(int com1, int dat1)				//write cmd and save to memory
 {
@@ -159,149 +57,174 @@ void address_set(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int
 
 void LCD_screen_color(unsigned int color)
 {
-	int i,j;
-	address_set(0, 0, 239, 319);
+	address_set(0, 0, MAX_X - 1, MAX_Y - 1);
+	LCD_burst_fill(color, (unsigned long)MAX_X * MAX_Y);
+}
+
+
+void draw_line(signed int x1, signed int y1, signed int x2, signed int y2, unsigned int colour);
+void print_str_P(unsigned int x_pos, unsigned int y_pos, unsigned char font_size, unsigned int colour, unsigned int back_colour, PGM_P ch);
+void fill_rect(signed int x_pos, signed int y_pos, signed int width, signed int height, unsigned int colour);
+
+uint8_t band_key(const band_t *band, uint8_t i)						//index in keys[] of the band's i-th key on the current page
+{
+	return band->first + (key_page < band->pages ? key_page : 0) * band->cols * band->rows + i;
+}
 
-	for(i = 0; i < 320; i++)
+void draw_labels(uint8_t b)
+{
+	band_t band;
+	uint8_t i, k;
+	unsigned int x, y;
+	
+	memcpy_P(&band, &bands[b], sizeof(band_t));
+	
+	for (i = 0; i < band.cols * band.rows; i++)
 	{
-		for (j = 0; j < 240; j++)
+		k = band_key(&band, i);
+		x = pgm_read_byte(&keys[k].x) + band.label_x;
+		y = pgm_read_word(&keys[k].y) + band.label_y;
+		
+		if (band.pages > 1)												//clear the other page's label, lines stay
 		{
-			LCD_write_data(color);
+			fill_rect(x, y, band.w - band.label_x - 1, band.font_size << 3, BLACK);
 		}
+		print_str_P(x, y, band.font_size, WHITE, BLACK, keys[k].label);
 	}
 }
 
-
-void draw_calc()
+void draw_band(uint8_t b, bool clear)									//clear for GRAM that still holds power on noise
 {
-	//draw top menu for choosing decimal system
-	draw_line(0, 40, MAX_X, 40, WHITE);
-	for (int i = MAX_X / 4; i < MAX_X; i = i + MAX_X / 4)
-	{
-		draw_line(i, 0, i, 40, WHITE);
-	}
+	band_t band;
+	uint8_t i;
+	unsigned int y;
+	
+	memcpy_P(&band, &bands[b], sizeof(band_t));
 	
-	//draw actual calculator lines
-	for (int j = 100; j < MAX_Y; j = j + (MAX_Y - 100) / 5)
+	if (clear)
 	{
-		draw_line(0, j, MAX_X, j, WHITE);
+		fill_rect(0, band.y, MAX_X, band.rows * band.h, BLACK);
 	}
 	
-	for (int i = MAX_X / 4; i < MAX_X; i = i + MAX_X / 4)
+	for (i = 0; i <= band.rows; i++)									//row edges, screen borders get no line
 	{
-		draw_line(i, 100, i, MAX_Y - (MAX_Y - 100) / 5, WHITE);
+		y = band.y + i * band.h;
+		if (y > 0 && y < MAX_Y)
+		{
+			draw_line(0, y, MAX_X, y, WHITE);
+		}
 	}
 	
-	for (int i = MAX_X / 5; i < MAX_X; i = i + MAX_X / 6)
+	for (i = 1; i < band.cols; i++)
 	{
-		draw_line(i, MAX_Y - (MAX_Y - 100) / 6, i, MAX_Y, WHITE);
+		draw_line(i * band.w, band.y, i * band.w, band.y + band.rows * band.h, WHITE);
 	}
 	
-	//draw characters
-	print_str(220, 286, 3, WHITE, BLACK, "A");
-	print_str(180, 286, 3, WHITE, BLACK, "B");
-	print_str(140, 286, 3, WHITE, BLACK, "C");
-	print_str(100, 286, 3, WHITE, BLACK, "D");
-	print_str(60, 286, 3, WHITE, BLACK, "E");
-	print_str(20, 286, 3, WHITE, BLACK, "F");
-	
-	print_str(195, 12, 2, WHITE, BLACK, "BIN");
-	print_str(135, 12, 2, WHITE, BLACK, "OCT");
-	print_str(75, 12, 2, WHITE, BLACK, "DEC");
-	print_str(15, 12, 2, WHITE, BLACK, "HEX");
-	
-	print_str(200, 110, 3, WHITE, BLACK, "7");
-	print_str(140, 110, 3, WHITE, BLACK, "8");
-	print_str(80, 110, 3, WHITE, BLACK, "9");
-	print_str(20, 110, 3, WHITE, BLACK, "/");
-	
-	print_str(200, 154, 3, WHITE, BLACK, "4");
-	print_str(140, 154, 3, WHITE, BLACK, "5");
-	print_str(80, 154, 3, WHITE, BLACK, "6");
-	print_str(20, 154, 3, WHITE, BLACK, "x");
-	
-	print_str(200, 198, 3, WHITE, BLACK, "1");
-	print_str(140, 198, 3, WHITE, BLACK, "2");
-	print_str(80, 198, 3, WHITE, BLACK, "3");
-	print_str(20, 198, 3, WHITE, BLACK, "+");
-	
-	print_str(200, 242, 3, WHITE, BLACK, "0");
-	print_str(140, 242, 3, WHITE, BLACK, "CLR");
-	print_str(80, 242, 3, WHITE, BLACK, "=");
-	print_str(20, 242, 3, WHITE, BLACK, "-");
-	
-	
+	draw_labels(b);
 }
 
-void init(void)
+void draw_calc()
 {
-	DDRA = 0xff;
-	DDRB = 0xff;
-	DDRD = 0xff;
-	DDRC = 0xff;
+	uint8_t b;
 	
-	DDRD = ~(_BV(T_OUT) | _BV(T_IRQ));						//input pins that read data
-		
-	//LCD config setup
-	PORTD |= _BV(LCD_RESET);
-	_delay_ms(5);
-	PORTD &= ~_BV(LCD_RESET);
-	_delay_ms(10);
-	PORTD |= _BV(LCD_RESET);
-	PORTC |= _BV(LCD_CS);
-	PORTC |= _BV(LCD_RD);
-	PORTC &= ~_BV(LCD_WR);
-	_delay_ms(20);
-
-	LCD_write_cmd_data(0x0000,0x0001);    _delay_ms(1);
-	LCD_write_cmd_data(0x0003,0xA8A4);    _delay_ms(1);
-	LCD_write_cmd_data(0x000C,0x0000);    _delay_ms(1);
-	LCD_write_cmd_data(0x000D,0x080C);    _delay_ms(1);
-	LCD_write_cmd_data(0x000E,0x2B00);    _delay_ms(1);
-	LCD_write_cmd_data(0x001E,0x00B0);    _delay_ms(1);
-	LCD_write_cmd_data(0x0001,0x2B3F);    _delay_ms(1);
-	LCD_write_cmd_data(0x0002,0x0600);    _delay_ms(1);
-	LCD_write_cmd_data(0x0010,0x0000);    _delay_ms(1);
-	LCD_write_cmd_data(0x0011,0x6070);    _delay_ms(1);
-	LCD_write_cmd_data(0x0005,0x0000);    _delay_ms(1);
-	LCD_write_cmd_data(0x0006,0x0000);    _delay_ms(1);
-	LCD_write_cmd_data(0x0016,0xEF1C);    _delay_ms(1);
-	LCD_write_cmd_data(0x0017,0x0003);    _delay_ms(1);
-	LCD_write_cmd_data(0x0007,0x0233);    _delay_ms(1);
-	LCD_write_cmd_data(0x000B,0x0000);    _delay_ms(1);
-	LCD_write_cmd_data(0x000F,0x0000);    _delay_ms(1);
-	LCD_write_cmd_data(0x0041,0x0000);    _delay_ms(1);
-	LCD_write_cmd_data(0x0042,0x0000);    _delay_ms(1);
-	LCD_write_cmd_data(0x0048,0x0000);    _delay_ms(1);
-	LCD_write_cmd_data(0x0049,0x013F);    _delay_ms(1);
-	LCD_write_cmd_data(0x004A,0x0000);    _delay_ms(1);
-	LCD_write_cmd_data(0x004B,0x0000);    _delay_ms(1);
-	LCD_write_cmd_data(0x0044,0xEF00);    _delay_ms(1);
-	LCD_write_cmd_data(0x0045,0x0000);    _delay_ms(1);
-	LCD_write_cmd_data(0x0046,0x013F);    _delay_ms(1);
-	LCD_write_cmd_data(0x0030,0x0707);    _delay_ms(1);
-	LCD_write_cmd_data(0x0031,0x0204);    _delay_ms(1);
-	LCD_write_cmd_data(0x0032,0x0204);    _delay_ms(1);
-	LCD_write_cmd_data(0x0033,0x0502);    _delay_ms(1);
-	LCD_write_cmd_data(0x0034,0x0507);    _delay_ms(1);
-	LCD_write_cmd_data(0x0035,0x0204);    _delay_ms(1);
-	LCD_write_cmd_data(0x0036,0x0204);    _delay_ms(1);
-	LCD_write_cmd_data(0x0037,0x0502);    _delay_ms(1);
-	LCD_write_cmd_data(0x003A,0x0302);    _delay_ms(1);
-	LCD_write_cmd_data(0x003B,0x0302);    _delay_ms(1);
-	LCD_write_cmd_data(0x0023,0x0000);    _delay_ms(1);
-	LCD_write_cmd_data(0x0024,0x0000);    _delay_ms(1);
-	LCD_write_cmd_data(0x004f,0);
-	LCD_write_cmd_data(0x004e,0);
-	LCD_write_cmd(0x0022);
+	PROF_BEGIN(DRAW_CALC);
+	for (b = 0; b < BAND_CNT; b++)
+	{
+		draw_band(b, false);
+	}
+	PROF_END(DRAW_CALC);
+}
+
+/*LCD init*/
+typedef struct
+{
+	uint8_t reg;
+	uint16_t value;
+	uint8_t delay_ms;			//wait after the write
+} lcd_reg_t;
+
+static const lcd_reg_t lcd_init_seq[] PROGMEM =		//SSD1289 power on and panel setup, only sleep off needs time
+{
+	 {0x00, 0x0001, 0}
+	,{0x03, 0xA8A4, 0}
+	,{0x0C, 0x0000, 0}
+	,{0x0D, 0x080C, 0}
+	,{0x0E, 0x2B00, 0}
+	,{0x1E, 0x00B0, 0}
+	,{0x01, 0x2B3F, 0}
+	,{0x02, 0x0600, 0}
+	,{0x10, 0x0000, 30}	//sleep off, the power circuits settle before anything is shown
+	,{0x11, 0x6070, 0}
+	,{0x05, 0x0000, 0}
+	,{0x06, 0x0000, 0}
+	,{0x16, 0xEF1C, 0}
+	,{0x17, 0x0003, 0}
+	,{0x07, 0x0233, 0}
+	,{0x0B, 0x0000, 0}
+	,{0x0F, 0x0000, 0}
+	,{0x41, 0x0000, 0}
+	,{0x42, 0x0000, 0}
+	,{0x48, 0x0000, 0}
+	,{0x49, 0x013F, 0}
+	,{0x4A, 0x0000, 0}
+	,{0x4B, 0x0000, 0}
+	,{0x44, 0xEF00, 0}
+	,{0x45, 0x0000, 0}
+	,{0x46, 0x013F, 0}
+	,{0x30, 0x0707, 0}
+	,{0x31, 0x0204, 0}
+	,{0x32, 0x0204, 0}
+	,{0x33, 0x0502, 0}
+	,{0x34, 0x0507, 0}
+	,{0x35, 0x0204, 0}
+	,{0x36, 0x0204, 0}
+	,{0x37, 0x0502, 0}
+	,{0x3A, 0x0302, 0}
+	,{0x3B, 0x0302, 0}
+	,{0x23, 0x0000, 0}
+	,{0x24, 0x0000, 0}
+	,{0x4F, 0x0000, 0}
+	,{0x4E, 0x0000, 0}
+};
+/*end LCD init*/
+
+void init(void)															//registers from the table, the screen is cleared by what draws first
+{
+	lcd_reg_t r;
+	uint8_t i;
 	
-	LCD_screen_color(BLACK);
+	LCD_reset();
+	for (i = 0; i < sizeof(lcd_init_seq) / sizeof(lcd_init_seq[0]); i++)
+	{
+		memcpy_P(&r, &lcd_init_seq[i], sizeof(lcd_reg_t));
+		LCD_write_cmd_data(r.reg, r.value);
+		while (r.delay_ms--)
+		{
+			_delay_ms(1);
+		}
+	}
+	memset(result_shown, ' ', MAX_CHARS);
 	
-	draw_calc();
+	touch_init();
+	PROF_INIT();
+}
+
+bool window_full = true;	//false while a primitive has narrowed the GRAM window
+
+void TFT_set_window(unsigned int x_pos, unsigned int y_pos, unsigned int width, unsigned int height)	//open window for one primitive, pixels then stream left to right starting from the bottom row
+{
+	window_full = false;
+	address_set(x_pos, MAX_Y - y_pos - height, x_pos + width - 1, MAX_Y - 1 - y_pos);
 }
 
 void TFT_set_cursor(signed int x_pos, signed int y_pos)
 {
+	if (!window_full)
+	{
+		address_set(0, 0, MAX_X - 1, MAX_Y - 1);
+		window_full = true;
+	}
+	
 	y_pos = (MAX_Y - 1 - y_pos);
 	
 	LCD_write_cmd_data(0x004E, x_pos);
@@ -313,10 +236,54 @@ void draw_pixel(signed int x_pos, signed int y_pos, unsigned int colour)
 {
 	if((x_pos >= MAX_X) || (y_pos >= MAX_Y) || (x_pos < 0) || (y_pos < 0)) return;
 	
-	PORTC &= ~_BV(LCD_CS);
 	TFT_set_cursor(x_pos, y_pos);
 	LCD_write_data(colour);
-	PORTC |= _BV(LCD_CS);
+}
+
+void fill_rect(signed int x_pos, signed int y_pos, signed int width, signed int height, unsigned int colour)
+{
+	if (x_pos < 0)
+	{
+		width += x_pos;
+		x_pos = 0;
+	}
+	if (y_pos < 0)
+	{
+		height += y_pos;
+		y_pos = 0;
+	}
+	if (x_pos + width > MAX_X) width = MAX_X - x_pos;
+	if (y_pos + height > MAX_Y) height = MAX_Y - y_pos;
+	if (width <= 0 || height <= 0) return;
+	
+	TFT_set_window(x_pos, y_pos, width, height);
+	LCD_burst_fill(colour, (unsigned long)width * height);
+}
+
+void rect_read(unsigned int x_pos, unsigned int y_pos, unsigned int width, unsigned int height, unsigned int *px)	//GRAM into px, in the order rect_write takes it back
+{
+	unsigned int n = width * height;
+	
+	TFT_set_window(x_pos, y_pos, width, height);
+	LCD_read_begin();
+	while (n--)
+	{
+		*px++ = LCD_read_pixel();
+	}
+	LCD_read_end();
+}
+
+void rect_write(unsigned int x_pos, unsigned int y_pos, unsigned int width, unsigned int height, const unsigned int *px)
+{
+	unsigned int n = width * height;
+	
+	TFT_set_window(x_pos, y_pos, width, height);
+	LCD_burst_begin();
+	while (n--)
+	{
+		LCD_burst_pixel(*px++);
+	}
+	LCD_burst_end();
 }
 
 void draw_line(signed int x1, signed int y1, signed int x2, signed int y2, unsigned int colour)
@@ -327,6 +294,17 @@ void draw_line(signed int x1, signed int y1, signed int x2, signed int y2, unsig
 	signed int stepy = 0x0000;
 	signed int fraction = 0x0000;
 
+	if (y1 == y2)													//grid lines are a one pixel high or wide rect
+	{
+		fill_rect(x1 < x2 ? x1 : x2, y1, abs(x2 - x1) + 1, 1, colour);
+		return;
+	}
+	if (x1 == x2)
+	{
+		fill_rect(x1, y1 < y2 ? y1 : y2, 1, abs(y2 - y1) + 1, colour);
+		return;
+	}
+
 	dy = (y2 - y1);
 	dx = (x2 - x1);
 
@@ -391,29 +369,53 @@ void draw_line(signed int x1, signed int y1, signed int x2, signed int y2, unsig
 }
 
 
-void draw_font_pixel(unsigned int x_pos, unsigned int y_pos, unsigned int colour, unsigned char pixel_size)
-{
-	int i = 0x0000;
+#define GLYPH_W 5		//font columns, one pixel wide each
+#define CELL_W 12		//glyph plus spacing, the step print_str has always used
 
-	PORTC &= ~_BV(LCD_CS);
+void blit_text(unsigned int x_pos, unsigned int y_pos, unsigned char font_size, unsigned int colour, unsigned int back_colour, const char *ch, uint8_t len, uint8_t cell_w, bool reverse)	//len glyphs side by side in one window and one burst, reverse walks ch from its end
+{
+	signed char j = 0x00;
+	uint8_t rep, i, c, row;
+	const unsigned char *glyph;
 	
-	TFT_set_cursor(x_pos, y_pos);
+	TFT_set_window(x_pos, y_pos, len * cell_w, font_size << 0x03);
+	LCD_burst_begin();
 	
-	for(i = 0x0000; i < (pixel_size * pixel_size); i++)
+	for(j = 0x07; j >= 0x00; j--)											//window is filled bottom row first
 	{
-		LCD_write_data(colour);
+		for(rep = 0x00; rep < font_size; rep++)
+		{
+			for(i = 0x00; i < len; i++)
+			{
+				glyph = font[ ( (unsigned char)ch[reverse ? len - 1 - i : i] ) - 0x20 ];
+				row = 0x00;
+				
+				for(c = 0x00; c < GLYPH_W; c++)								//columns are mirrored, as the display is
+				{
+					row |= ((pgm_read_byte(&glyph[GLYPH_W - 1 - c]) >> j) & 0x01) << c;
+				}
+				
+				for(c = 0x00; c < cell_w; c++)
+				{
+					if(row & 0x01)
+					{
+						LCD_burst_pixel(colour);
+					}
+					else
+					{
+						LCD_burst_pixel(back_colour);
+					}
+					row >>= 1;
+				}
+			}
+		}
 	}
 	
-	PORTC |= _BV(LCD_CS);
+	LCD_burst_end();
 }
 
 void print_char(unsigned int x_pos, unsigned int y_pos, unsigned char font_size, unsigned int colour, unsigned int back_colour, char ch)
 {
-	signed char i = 0x00;
-	unsigned char j = 0x00;
-
-	unsigned int value = 0x0000;
-
 	if(font_size <= 0)
 	{
 		font_size = 1;
@@ -423,407 +425,1067 @@ void print_char(unsigned int x_pos, unsigned int y_pos, unsigned char font_size,
 	{
 		x_pos = font_size;
 	}
+	
+	blit_text(x_pos, y_pos, font_size, colour, back_colour, &ch, 1, GLYPH_W, false);
+}
 
-	for(i = 0x04; i >= 0x00; i--)
+uint8_t text_len(const char *ch)										//printable characters before the end, '_' or a terminator
+{
+	uint8_t len = 0;
+	
+	while (len < NUM_CHARS && (ch[len] >= 0x20) && (ch[len] <= 0x7F) && ch[len] != 0x5f)
 	{
-		for(j = 0x00; j < 0x08; j++)
-		{
-			value = 0x0000;
-			value = ( (font[ ( (unsigned char)ch ) - 0x20 ][i]) );
-
-			if(((value >> j) & 0x01) != 0x00)
-			{
-				draw_font_pixel(x_pos, y_pos, colour, font_size);
-			}
-			else
-			{
-				draw_font_pixel(x_pos, y_pos, back_colour, font_size);
-			}
+		len++;
+	}
+	
+	return len;
+}
 
-			y_pos += font_size;
-		}
-		y_pos -= (font_size << 0x03);
-		x_pos++;
+void print_str(unsigned int x_pos, unsigned int y_pos, unsigned char font_size, unsigned int colour, unsigned int back_colour, const char *ch)
+{
+	uint8_t len = text_len(ch);
+	
+	PROF_BEGIN(PRINT_STR);
+	if (len)															//display is mirrored, the text starts on the low x end
+	{
+		blit_text(x_pos, y_pos, font_size, colour, back_colour, ch, len, CELL_W, true);
 	}
+	PROF_END(PRINT_STR);
 }
 
-void print_str(unsigned int x_pos, unsigned int y_pos, unsigned char font_size, unsigned int colour, unsigned int back_colour, char *ch)
+void print_str_P(unsigned int x_pos, unsigned int y_pos, unsigned char font_size, unsigned int colour, unsigned int back_colour, PGM_P ch)	//same as print_str, string stays in flash
 {
-	int cnt = 0;
-	strrev(ch);
+	uint8_t len = 0, cnt = strlen_P(ch);
+	char cells[MAX_CHARS];
+	char c;
 	
-	while( (ch[cnt] >= 0x20) && (ch[cnt] <= 0x7F) )
+	while (cnt > 0 && len < MAX_CHARS)										//read backwards, flash can't be reversed in place
 	{
-		if (ch[cnt] == 0x5f) 
+		c = pgm_read_byte(&ch[--cnt]);
+		if (c < 0x20 || c > 0x7F)
 		{
-			cnt++;
-			continue;
+			break;
+		}
+		if (c != 0x5f)
+		{
+			cells[len++] = c;
 		}
-		print_char(x_pos, y_pos, font_size, colour, back_colour, ch[cnt++]);
-		x_pos += 0x06;
-		print_char(x_pos, y_pos, font_size, colour, back_colour, 0x20);
-		x_pos += 0x06;
+	}
+	
+	if (len)
+	{
+		blit_text(x_pos, y_pos, font_size, colour, back_colour, cells, len, CELL_W, false);
 	}
 }
 
-char num_to_char(int n)
+/*result line*/
+#define RESULT_X 20
+#define RESULT_Y 60
+#define RESULT_SIZE 3
+#define STATUS_Y 88
+/*end result line*/
+
+/*readout, the value in all four bases between the menu and the pad*/
+#define READOUT_X 4
+#define READOUT_Y 42
+#define READOUT_PITCH 11		//row to row, one font_size 1 line plus a gap
+#define READOUT_CELLS 36
+#define READOUT_CELL_W 6		//glyph plus one column, small text packs tighter than CELL_W
+#define READOUT_LABEL_X (READOUT_X + READOUT_CELLS * READOUT_CELL_W + 4)
+/*end readout*/
+
+/*text fields*/
+#define FIELD_RESULT 0
+#define FIELD_READOUT 1			//first of four rows, HEX DEC OCT BIN from the top
+#define FIELD_CNT 5
+
+typedef struct
 {
-	if (n < 10)
-		return n + 48;
-	if (n < 16)
-		return n + 'A' - 10;
-	return 0;
-}
+	signed int x, y;
+	uint8_t size, cells, cell_w;
+	char *shown;				//what is on the screen now, cell 0 is the last character
+} field_t;
+
+char readout_shown[4][READOUT_CELLS];
+
+const field_t fields[FIELD_CNT] PROGMEM = {
+	{RESULT_X, RESULT_Y, RESULT_SIZE, MAX_CHARS, CELL_W, result_shown},
+	{READOUT_X, READOUT_Y, 1, READOUT_CELLS, READOUT_CELL_W, readout_shown[0]},
+	{READOUT_X, READOUT_Y + READOUT_PITCH, 1, READOUT_CELLS, READOUT_CELL_W, readout_shown[1]},
+	{READOUT_X, READOUT_Y + 2 * READOUT_PITCH, 1, READOUT_CELLS, READOUT_CELL_W, readout_shown[2]},
+	{READOUT_X, READOUT_Y + 3 * READOUT_PITCH, 1, READOUT_CELLS, READOUT_CELL_W, readout_shown[3]}
+};
+
+const uint8_t readout_base[4] PROGMEM = {16, 10, 8, 2};
+const char readout_label[4][2] PROGMEM = {"H", "D", "O", "B"};
+
+bool readout_on = false;		//the readout takes the place of the result line
+/*end text fields*/
 
-int char_to_num(char c)
+/*dirty rectangles*/
+#define DIRTY_MAX 4
+
+typedef struct
 {
-	if (c >= 'A' && c <= 'F')
-		return c - 'A' + 10;
-	return c - '0';
-}
+	signed int x, y, w, h;
+} rect_t;
 
-int convert(int system,  char *number)
+rect_t dirty[DIRTY_MAX];		//regions that changed since the last render_flush
+uint8_t dirty_cnt = 0;
+/*end dirty rectangles*/
+
+void rect_union(rect_t *r, signed int x, signed int y, signed int w, signed int h)
 {
-	int n = 0;
-	int negate = -(number[0] == '-');
-	for (int i = -negate; number[i] != '_'; i++)
-	{
-		n = n * system + char_to_num(number[i]);
-	}
+	signed int x2 = r->x + r->w, y2 = r->y + r->h;
 	
-	return n + negate ^ negate;
+	if (x + w > x2) x2 = x + w;
+	if (y + h > y2) y2 = y + h;
+	if (x < r->x) r->x = x;
+	if (y < r->y) r->y = y;
+	r->w = x2 - r->x;
+	r->h = y2 - r->y;
 }
 
-void convert_system(int res, int system, char *out)
+void dirty_add(signed int x, signed int y, signed int w, signed int h)
 {
-	int n = 0, i = 0;
-	char negative = res < 0;
-	res = abs(res);
-	do
+	uint8_t i;
+	
+	for (i = 0; i < dirty_cnt; i++)										//touching rects are merged, neighbouring cells become one span
+	{
+		if (x <= dirty[i].x + dirty[i].w && dirty[i].x <= x + w && y <= dirty[i].y + dirty[i].h && dirty[i].y <= y + h)
+		{
+			rect_union(&dirty[i], x, y, w, h);
+			return;
+		}
+	}
+	
+	if (dirty_cnt == DIRTY_MAX)											//out of slots, grow the last one
 	{
-		n = res % system;
-		out[i++] = num_to_char(n);
-		res /= system;
+		rect_union(&dirty[DIRTY_MAX - 1], x, y, w, h);
+		return;
 	}
-	while (res != 0);
-	if (negative)
-		out[i++] = '-';
-	out[i] = 0;
-	strrev(out);
-	out[i] = '_';
+	
+	dirty[dirty_cnt].x = x;
+	dirty[dirty_cnt].y = y;
+	dirty[dirty_cnt].w = w;
+	dirty[dirty_cnt].h = h;
+	dirty_cnt++;
 }
 
+bool field_active(uint8_t f)
+{
+	return (f == FIELD_RESULT) != readout_on;
+}
 
-int calculate(int a, int b, char sign)
+void field_show(uint8_t f, const char *str)								//right aligned, compare with the screen, only changed cells are marked dirty
 {
-	int result = 0;
+	field_t field;
+	uint8_t len = text_len(str), k;
 	
-	if (sign == '+') result = a + b;
-	else if (sign == '-') result = a - b;
-	else if (sign == '/') result = a / b;
-	else if (sign == 'x') result = a * b;
+	if (!field_active(f))
+	{
+		return;
+	}
+	memcpy_P(&field, &fields[f], sizeof(field_t));
 	
-	return result;
+	for (k = 0; k < field.cells; k++)
+	{
+		char c = k < len ? str[len - 1 - k] : ' ';
+		
+		if (k == field.cells - 1 && len > field.cells)					//longer than the field, mark the cut off digits
+		{
+			c = '<';
+		}
+		
+		if (c != field.shown[k])
+		{
+			field.shown[k] = c;
+			dirty_add(field.x + k * field.cell_w, field.y, field.cell_w, field.size << 3);
+		}
+	}
 }
 
-char get_clicked_number(int cnt, int system)
+void render_flush(void)													//redraw only what lies under dirty rects
 {
-	if (cnt < MAX_CHARS)
+	field_t field;
+	uint8_t f, i, k, first, last;
+	
+	PROF_BEGIN(RENDER_FLUSH);
+	for (f = 0; f < FIELD_CNT; f++)
 	{
-		if (system >= 16)
+		if (!field_active(f))
 		{
-			//A
-			if (T_X >= 200 && T_X < 240 && T_Y >= 276 && T_Y < 320)
-			{
-				return 'A';
-			}
-		
-			//B
-			else if (T_X >= 160 && T_X < 200 && T_Y >= 276 && T_Y < 320)
-			{
-				return 'B';
-			}
-		
-			//C
-			else if (T_X >= 120 && T_X < 160 && T_Y >= 276 && T_Y < 320)
-			{
-				return 'C';
-			}
-		
-			//D
-			else if (T_X >= 80 && T_X < 120 && T_Y >= 276 && T_Y < 320)
-			{
-				return 'D';
-			}
-		
-			//E
-			else if (T_X >= 40 && T_X < 80 && T_Y >= 276 && T_Y < 320)
-			{
-				return 'E';
-			}
-		
-			//F
-			else if (T_X < 40 && T_Y >= 276 && T_Y < 320)
-			{
-				return 'F';
-			}
+			continue;
 		}
+		memcpy_P(&field, &fields[f], sizeof(field_t));
 		
-		if (system >= 10)
+		for (i = 0; i < dirty_cnt; i++)
 		{
-			//8
-			if (T_X >= 120 && T_X < 180 && T_Y >= 100 && T_Y < 144)
+			if (field.y >= dirty[i].y + dirty[i].h || dirty[i].y >= field.y + (field.size << 3))
 			{
-				return '8';
+				continue;
 			}
+			first = field.cells;
+			last = 0;
 			
-			//9
-			else if (T_X >= 60 && T_X < 120 && T_Y >= 100 && T_Y < 144)
-			{
-				return '9';
-			}
-		}
-		
-		if (system >= 8)
-		{
-			//2
-			if (T_X >= 120 && T_X < 180 && T_Y >= 188 && T_Y < 232)
-			{
-				return '2';
-			}
-		
-			//3
-			else if (T_X >= 60 && T_X < 120 && T_Y >= 188 && T_Y < 232)
-			{
-				return '3';
-			}
-	
-			//4
-			else if (T_X >= 180 && T_Y >= 144 && T_Y < 188)
+			for (k = 0; k < field.cells; k++)
 			{
-				return '4';
-			}
-		
-			//5
-			else if (T_X >= 120 && T_X < 180 && T_Y >= 144 && T_Y < 188)
-			{
-				return '5';
-			}
-		
-			//6
-			else if (T_X >= 60 && T_X < 120 && T_Y >= 144 && T_Y < 188)
-			{
-				return '6';
+				signed int x = field.x + k * field.cell_w;
+				
+				if (x < dirty[i].x + dirty[i].w && dirty[i].x < x + field.cell_w)
+				{
+					if (first == field.cells) first = k;
+					last = k;
+				}
 			}
-		
-			//7
-			else if (T_X >= 180 && T_Y >= 100 && T_Y < 144)
+			
+			if (first < field.cells)										//a span of cells goes out as one burst
 			{
-				return '7';
+				blit_text(field.x + first * field.cell_w, field.y, field.size, WHITE, BLACK, field.shown + first, last - first + 1, field.cell_w, false);
 			}
 		}
+	}
 	
-		
-		//0
-		if (T_X >= 180 && T_Y >= 232 && T_Y < 276)
-		{
-			return '0';
-		}
+	dirty_cnt = 0;
+	PROF_END(RENDER_FLUSH);
+}
+
+void readout_labels(uint8_t system)										//base names on the viewer's left, the one typed in is red
+{
+	uint8_t i;
 	
-		//1
-		else if (T_X >= 180 && T_Y >= 188 && T_Y < 232)
-		{
-			return '1';
-		}
+	for (i = 0; i < 4; i++)
+	{
+		print_str_P(READOUT_LABEL_X, READOUT_Y + i * READOUT_PITCH, 1, pgm_read_byte(&readout_base[i]) == system ? RED : WHITE, BLACK, readout_label[i]);
 	}
-	return 0;
 }
 
-int main(void)
+void readout_show(calc_t value)											//every base from the one value, each row only redraws its changed digits
 {
-	init();
+	char digits[NUM_CHARS + 1];
+	uint8_t i;
 	
-	int res = 0, system = 10;
-	int cnt = 0;
-	int calc = 0;
-	char sign = '_';
-	char res_print[MAX_CHARS];
-	int print_calculated = 0;
-	int remember_ans = 0;
+	if (!readout_on)
+	{
+		return;
+	}
 	
-    while (1) 
-    {
-		
-		if (getBit(PIND, T_IRQ) == 0)
-		{
-			touch_read_xy();
-			
-			T_X = (T_X - 80) / 8;
-			T_Y = (T_Y - 80) / 6;
-			
-			_delay_ms(500);
-			
-			//HEX
-			if (T_X <= 60 && T_X > 0 && T_Y <= 40 && T_Y > 0)
-			{
-				int number = convert(system, number_1);
-				system = 16;
-				convert_system(number, system, number_1);
-				
-			}
-			
-			//DEC
-			if (T_X >= 60 && T_X < 120 && T_Y <= 40 && T_Y > 0)
-			{
-				int number = convert(system, number_1);
-				system = 10;
-				convert_system(number, system, number_1);
-			}
-			
-			//OCT
-			if (T_X >= 120 && T_X < 180 && T_Y <= 40 && T_Y > 0)
-			{
-				int number = convert(system, number_1);
-				system = 8;
-				convert_system(number, system, number_1);
-			}
-			
-			//BIN
-			if (T_X >= 180 && T_X < 240 && T_Y <= 40 && T_Y > 0)
-			{
-				int number = convert(system, number_1);
-				system = 2;
-				convert_system(number, system, number_1);
-			}
-			
-			char cur_num = get_clicked_number(cnt, system);
-			if (cur_num)
-			{
-				if (remember_ans)
-				{
-					strcpy(number_1, BLANK);
-					remember_ans = 0;
-				}
-				number_1[cnt++] = cur_num;
-			}
+	for (i = 0; i < 4; i++)
+	{
+		convert_system(value, pgm_read_byte(&readout_base[i]), digits);
+		field_show(FIELD_READOUT + i, digits);
+	}
+}
+
+void value_show(const char *str, calc_t value)							//whichever of the result line and the readout is up
+{
+	field_show(FIELD_RESULT, str);
+	readout_show(value);
+	render_flush();
+}
+
+void fields_blank(void)													//the screen under the fields was cleared, the next show draws every cell
+{
+	memset(result_shown, ' ', MAX_CHARS);
+	memset(readout_shown, ' ', sizeof(readout_shown));
+	dirty_cnt = 0;
+}
+
+void readout_toggle(uint8_t system)										//swap the result line and the readout, the new one is drawn from blank
+{
+	readout_on = !readout_on;
+	fill_rect(0, READOUT_Y - 1, MAX_X, STATUS_Y - READOUT_Y, BLACK);
+	fields_blank();
+	
+	if (readout_on)
+	{
+		readout_labels(system);
+	}
+}
+
+/*calculator state*/
+calc_t entry = 0;						//value of number_1, kept up to date instead of parsed back
+int num_system = 10;
+int cnt = 0;
+int remember_ans = 0;
+calc_t memory = 0;						//M register
+uint8_t hist_pos = 0;					//answers back while browsing the history, 0 when not
+bool frame_dirty = false;				//state changed since the last frame
+/*end calculator state*/
+
+void status_show(bool force)											//error flags and word size under the result, redrawn only when they change
+{
+	static uint8_t shown = 0, shown_bits = 0, shown_pos = 0;
+	static bool shown_mem = false, shown_signed = false;
+	char word[] = "UINT64";
+	char ans[] = "ANS-1  ";
+	uint8_t i = 4;
+	
+	if (!force && calc_status == shown && calc_bits == shown_bits && calc_signed == shown_signed && hist_pos == shown_pos && (memory != 0) == shown_mem)
+	{
+		return;
+	}
+	shown = calc_status;
+	shown_bits = calc_bits;
+	shown_signed = calc_signed;
+	shown_pos = hist_pos;
+	shown_mem = memory != 0;
+	
+	fill_rect(RESULT_X, STATUS_Y, MAX_CHARS * CELL_W, 8, BLACK);
+	if (calc_bits >= 10)
+	{
+		word[i++] = '0' + calc_bits / 10;
+	}
+	word[i++] = '0' + calc_bits % 10;
+	word[i] = 0;
+	print_str(RESULT_X + (MAX_CHARS - 6) * CELL_W, STATUS_Y, 1, WHITE, BLACK, calc_signed ? word + 1 : word);	//INT32 or UINT32, right edge fixed
+	
+	if (calc_status & CALC_DIV_ZERO)
+	{
+		print_str_P(RESULT_X, STATUS_Y, 1, RED, BLACK, PSTR("DIV BY 0"));
+	}
+	else if (calc_status & CALC_OVERFLOW)
+	{
+		print_str_P(RESULT_X, STATUS_Y, 1, RED, BLACK, PSTR("OVERFLOW"));
+	}
+	else if (hist_pos)
+	{
+		hist_entry_t e;
+		
+		hist_get(hist_pos - 1, &e);
+		ans[4] = '0' + hist_pos;
+		ans[6] = e.op ? e.op : ' ';
+		print_str(RESULT_X, STATUS_Y, 1, WHITE, BLACK, ans);
+	}
+	
+	if (shown_mem)
+	{
+		print_str_P(RESULT_X + 8 * CELL_W, STATUS_Y, 1, WHITE, BLACK, PSTR("M"));
+	}
+}
+
+void state_save(bool result)											//queued for the EEPROM log, written while waiting for touch
+{
+	hist_state_t state;
+	
+	state.value = entry;
+	state.memory = memory;
+	state.base = num_system;
+	state.bits = calc_bits;
+	state.is_signed = calc_signed;
+	state.op = result ? expr_root() : 0;									//the answer's own operator, from the = that gave it
+	hist_save(&state, result);
+}
+
+uint8_t key_at(unsigned int x, unsigned int y)							//band by y, then row and column straight from the grid
+{
+	band_t band;
+	uint8_t b;
+	
+	if (x >= MAX_X)
+	{
+		return KEY_NONE;
+	}
+	
+	for (b = 0; b < BAND_CNT; b++)
+	{
+		memcpy_P(&band, &bands[b], sizeof(band_t));
+		
+		if (y >= band.y && y < band.y + band.h * band.rows)
+		{
+			return band_key(&band, (y - band.y) / band.h * band.cols + x / band.w);
+		}
+	}
+	
+	return KEY_NONE;
+}
+
+void wait_event(touch_event_t *ev)											//sleep until the tick queues an event
+{
+	while (1)
+	{
+		hist_poll();														//a byte of a queued record each time the tick wakes us
+		
+		cli();
+		if (!input_pending())												//checked with interrupts off so no event slips in before sleeping
+		{
+			sleep_enable();
+			sei();
+			sleep_cpu();
+			sleep_disable();
+		}
+		sei();
+		
+		if (input_pop(ev))
+		{
+			return;
+		}
+	}
+}
+
+void draw_target(signed int x, signed int y, unsigned int colour)
+{
+	fill_rect(x - 7, y, 15, 1, colour);
+	fill_rect(x, y - 7, 1, 15, colour);
+}
+
+void calibrate(void)														//touch three crosses, the matrix goes to EEPROM
+{
+	static const int16_t target[3][2] PROGMEM = {{20, 20}, {220, 160}, {120, 300}};
+	int16_t screen[3][2];
+	unsigned int raw[3][2];
+	touch_event_t ev;
+	uint8_t i;
+	
+	memcpy_P(screen, target, sizeof(screen));
+	LCD_screen_color(BLACK);
+	
+	do
+	{
+		for (i = 0; i < 3; i++)
+		{
+			draw_target(screen[i][0], screen[i][1], RED);
 			
+			do
+			{
+				wait_event(&ev);
+			}
+			while (ev.type != EVENT_PRESS);
 			
+			raw[i][0] = ev.x;
+			raw[i][1] = ev.y;
+			draw_target(screen[i][0], screen[i][1], BLACK);
+		}
+	}
+	while (!calib_solve(screen, raw));
+}
+
+#define SHOT_PX 30				//pixels per reply line, as hex words
 
-			if (T_X < 60 && T_Y >= 100 && T_Y < 276)
+void screenshot(void)														//GRAM as hex text between SHOT and END, row 0 first, tools/shot.py turns it into an image
+{
+	unsigned long n = (unsigned long)MAX_X * MAX_Y;
+	char *reply;
+	uint8_t i, len;
+	unsigned int c;
+	
+	reply = serial_reply();												//SHOT width height, the numbers through the calculator's own formatter
+	strcpy_P(reply, PSTR("SHOT "));
+	len = strlen(reply);
+	convert_system(MAX_X, 10, reply + len);
+	len += text_len(reply + len);
+	reply[len++] = ' ';
+	convert_system(MAX_Y, 10, reply + len);
+	len += text_len(reply + len);
+	reply[len++] = '\n';
+	serial_send(len);
+	
+	address_set(0, 0, MAX_X - 1, MAX_Y - 1);
+	window_full = true;
+	LCD_read_begin();
+	while (n)
+	{
+		reply = serial_reply();
+		for (len = 0, i = 0; i < SHOT_PX && n; i++, n--)
+		{
+			c = LCD_read_pixel();
+			reply[len++] = num_to_char(c >> 12);
+			reply[len++] = num_to_char((c >> 8) & 0x0f);
+			reply[len++] = num_to_char((c >> 4) & 0x0f);
+			reply[len++] = num_to_char(c & 0x0f);
+		}
+		reply[len++] = '\n';
+		serial_send(len);
+	}
+	LCD_read_end();
+	
+	reply = serial_reply();
+	strcpy_P(reply, PSTR("END\n"));
+	serial_send(strlen(reply));
+}
+
+void serial_mode(void)													//expressions over USART until a line with just q, touch is off meanwhile
+{
+	char *line;
+	calc_t value = entry;
+	
+	expr_clear();
+	fill_rect(RESULT_X, STATUS_Y, MAX_CHARS * CELL_W, 8, BLACK);
+	print_str_P(RESULT_X, STATUS_Y, 1, WHITE, BLACK, PSTR("SERIAL"));
+	serial_open();
+	
+	while (1)
+	{
+		hist_poll();														//the persist task can't run meanwhile
+		
+		cli();
+		line = serial_line();
+		if (!line)
+		{
+			sleep_enable();
+			sei();
+			sleep_cpu();
+			sleep_disable();
+		}
+		sei();
+		
+		if (!line)
+		{
+			continue;
+		}
+		if (line[0] == 'q' && !line[1])
+		{
+			serial_line_done();
+			break;
+		}
+		if (strcmp_P(line, PSTR("shot")) == 0)
+		{
+			serial_line_done();
+			screenshot();
+			continue;
+		}
+		
+		serial_send(batch_eval(line, serial_reply(), &value));
+		serial_line_done();												//the receiver refills it while the reply goes out
+		
+		convert_system(value, num_system, number_1);
+		value_show(number_1, value);
+	}
+	
+	serial_close();
+	entry = value;
+	remember_ans = 1;
+	cnt = 0;
+	calc_clear_status();
+	status_show(true);
+	state_save(false);													//w:, s: and u: outlast the session
+}
+
+/*overlay, a key press mark that gives back what was under it*/
+#define OVERLAY_PX 104			//the bar under a pad key, the widest there is
+#define FLASH_INSET 4			//mark is a bar this far in from the key's sides
+#define FLASH_H 2
+#define FLASH_FRAMES 5			//render task runs, about 100 ms
+/*end overlay*/
+
+unsigned int overlay_px[OVERLAY_PX];
+rect_t overlay = {0, 0, 0, 0};				//w is 0 while nothing is up
+uint8_t overlay_left = 0;
+
+void overlay_restore(void)
+{
+	if (overlay.w)
+	{
+		rect_write(overlay.x, overlay.y, overlay.w, overlay.h, overlay_px);
+		overlay.w = 0;
+	}
+}
+
+void key_flash(const button_t *key)										//red bar along the bottom of a key, read first so taking it off is one write
+{
+	overlay_restore();
+	
+	overlay.x = key->x + FLASH_INSET;
+	overlay.y = key->y + key->h - FLASH_INSET - FLASH_H + 1;
+	overlay.w = key->w - 2 * FLASH_INSET;
+	overlay.h = FLASH_H;
+	if (overlay.w * overlay.h > OVERLAY_PX)
+	{
+		overlay.w = 0;
+		return;
+	}
+	
+	rect_read(overlay.x, overlay.y, overlay.w, overlay.h, overlay_px);
+	fill_rect(overlay.x, overlay.y, overlay.w, overlay.h, RED);
+	overlay_left = FLASH_FRAMES;
+}
+
+/*tape*/
+#define TAPE_SIZE 2
+#define TAPE_LINE_H (TAPE_SIZE << 3)
+#define TAPE_ROWS (MAX_Y / TAPE_LINE_H)		//the scroll wraps through GRAM, so lines have to tile it exactly
+#define TAPE_X 6
+#define TAPE_CELLS ((MAX_X - 2 * TAPE_X) / CELL_W)
+#define TAPE_DIGITS 16
+/*end tape*/
+
+void scroll_set(unsigned int lines)										//R41h, GRAM row shown on the first gate line of the panel
+{
+	LCD_write_cmd_data(0x0041, lines);
+}
+
+void tape_line(unsigned int y, uint8_t back)								//one answer from the log at GRAM text row y, blank if there is none
+{
+	char line[TAPE_CELLS];													//cell 0 is the right edge
+	char digits[NUM_CHARS + 1];
+	hist_entry_t e;
+	uint8_t len, k;
+	
+	memset(line, ' ', TAPE_CELLS);
+	if (hist_read(back, &e))
+	{
+		convert_system(e.value, e.base, digits);
+		len = text_len(digits);
+		for (k = 0; k < len && k < TAPE_DIGITS; k++)
+		{
+			line[k] = digits[len - 1 - k];
+		}
+		if (len > TAPE_DIGITS)
+		{
+			line[TAPE_DIGITS - 1] = '<';
+		}
+		line[TAPE_CELLS - 2] = e.base == 16 ? 'H' : e.base == 8 ? 'O' : e.base == 2 ? 'B' : 'D';
+		line[TAPE_CELLS - 1] = e.op ? e.op : ' ';
+	}
+	blit_text(TAPE_X, y, TAPE_SIZE, WHITE, BLACK, line, TAPE_CELLS, CELL_W, false);
+}
+
+void screen_redraw(void)												//everything back after a full screen view
+{
+	LCD_screen_color(BLACK);
+	draw_calc();
+	fields_blank();
+	if (readout_on)
+	{
+		readout_labels(num_system);
+	}
+	value_show(number_1, entry);
+	status_show(true);
+}
+
+void tape_mode(void)														//answers from the log, the top third scrolls back, the bottom third forward, the middle leaves
+{
+	touch_event_t ev;
+	unsigned int x, y, scroll = 0;
+	uint8_t top = TAPE_ROWS - 1, i;										//answers back on the top line, the newest sits at the bottom
+	hist_entry_t e;
+	
+	LCD_screen_color(BLACK);
+	for (i = 0; i < TAPE_ROWS; i++)
+	{
+		tape_line(i * TAPE_LINE_H, top - i);
+	}
+	
+	while (1)
+	{
+		wait_event(&ev);
+		calib_apply(ev.x, ev.y, &x, &y);
+		
+		if (y < MAX_Y / 3)
+		{
+			if (!hist_read(top + 1, &e))
 			{
-				char sign_mem = sign;
-					
-				// /
-				if (T_X < 60 && T_Y >= 100 && T_Y < 144)
-				{
-					sign = '/';
-				}
-					
-				//x
-				else if (T_X < 60 && T_Y >= 144 && T_Y < 188)
-				{
-					sign = 'x';
-				}
-					
-				//+
-				else if (T_X < 60 && T_Y >= 188 && T_Y < 232)
-				{
-					sign = '+';
-				}
-					
-				//-
-				else if (T_X < 60 && T_Y >= 232 && T_Y < 276)
-				{
-					sign = '-';
-				}
-					
-				if (calc)
+				continue;
+			}
+			top++;
+			scroll = (scroll + TAPE_LINE_H) % MAX_Y;						//everything moves down a line, the one that wrapped to the top gets the older answer
+			scroll_set(scroll);
+			tape_line((MAX_Y - scroll) % MAX_Y, top);
+		}
+		else if (y >= MAX_Y - MAX_Y / 3 && y < MAX_Y)
+		{
+			if (top < TAPE_ROWS)
+			{
+				continue;
+			}
+			top--;
+			scroll = (scroll + MAX_Y - TAPE_LINE_H) % MAX_Y;
+			scroll_set(scroll);
+			tape_line((2 * MAX_Y - TAPE_LINE_H - scroll) % MAX_Y, top - (TAPE_ROWS - 1));
+		}
+		else if (ev.type == EVENT_PRESS)
+		{
+			break;
+		}
+	}
+	
+	scroll_set(0);
+	screen_redraw();
+}
+
+void key_press(uint8_t k, uint8_t type)									//one key off the pad, type is the input event type
+{
+	button_t key;
+	
+	if (k == KEY_NONE)
+	{
+		return;
+	}
+	memcpy_P(&key, &keys[k], sizeof(button_t));
+	
+	static bool held = false;											//the hold action already ran for this press
+	
+	if (type == EVENT_PRESS)
+	{
+		held = false;
+		key_flash(&key);
+	}
+	else if (key.action == KEY_EQUALS && !held)							//= held down switches to the serial mode
+	{
+		held = true;
+		serial_mode();
+		return;
+	}
+	else if (key.action == KEY_HIST && !held)							//PRV or NXT held down opens the tape
+	{
+		held = true;
+		tape_mode();
+		return;
+	}
+	else if (key.action == KEY_BASE && !held)							//a base held down swaps in the readout of all four
+	{
+		held = true;
+		readout_toggle(num_system);
+		frame_dirty = true;
+		return;
+	}
+#ifndef NDEBUG
+	else if (key.action == KEY_CLEAR && !held)							//CLR held down sends the profiling ring
+	{
+		prof_dump();
+		held = true;
+	}
+#endif
+	
+	if (type == EVENT_REPEAT && key.action != KEY_DIGIT && key.action != KEY_DELETE)	//only digits and DEL auto-repeat
+	{
+		return;
+	}
+	
+	PROF_BEGIN(KEY_PRESS);
+	if (key.action != KEY_HIST)
+	{
+		hist_pos = 0;
+	}
+	
+	switch (key.action)
+	{
+		case KEY_BASE:
+		{
+			num_system = key.value;
+			convert_system(entry, num_system, number_1);
+			cnt = text_len(number_1);								//digits typed next extend the converted number
+			if (readout_on)
+			{
+				readout_labels(num_system);
+			}
+			state_save(false);
+			break;
+		}
+		
+		case KEY_DIGIT:
+		{
+			if (num_system >= key.min_base && cnt < NUM_CHARS)
+			{
+				if (remember_ans)
 				{
-					if (sign_mem == '_') sign_mem = sign;
-						
-					int a;
-					a = convert(system, number_1);
-						
-					res = calculate(number_1_mem, a, sign_mem);
-					number_1_mem = res;
-					convert_system(res, system, number_1);
+					strcpy_P(number_1, PSTR(BLANK));
+					entry = 0;
+					cnt = 0;
+					remember_ans = 0;
 				}
-				else 
+				
+				uint8_t status = calc_status;
+				bool wrapped;
+				calc_t typed;
+				
+				calc_status = 0;
+				typed = calc_digit(entry, num_system, char_to_num(key.value));
+				wrapped = calc_status & CALC_OVERFLOW;
+				calc_status = status;
+				
+				if (!wrapped && expr_number(typed))					//past the word, or no room for another number: drop the key
 				{
-					number_1_mem = convert(system, number_1);
-					calc = 1;
+					entry = typed;
+					number_1[cnt++] = key.value;
+					number_1[cnt] = '_';					//keep the end marker after the last digit
 				}
-					
+			}
+			break;
+		}
+		
+		case KEY_OP:
+		case KEY_PAREN:
+		{
+			bool done;
+			
+			if (key.action == KEY_OP && expr_empty())
+			{
+				expr_number(entry);									//go on from the number shown, the last answer after =
+			}
+			
+			if (key.action == KEY_OP)
+				done = expr_op(key.value);
+			else if (key.value == '(')
+				done = expr_open();
+			else
+				done = expr_close();
+			
+			if (done)
+			{
+				entry = expr_value();								//show what is worked out so far
+				convert_system(entry, num_system, number_1);
 				remember_ans = 1;
-				print_calculated = 1;
 				cnt = 0;
-				//strcpy(number_1, BLANK);
 			}
-			//=
-			else if (T_X >= 60 && T_X < 120 && T_Y >= 232 && T_Y < 276)
+			break;
+		}
+		
+		case KEY_EQUALS:
+		{
+			if (!expr_empty())
 			{
-				cnt = 0;
-				print_calculated = 1;
-					
-				int a;
-				a = convert(system, number_1);
-					
-				res = calculate(number_1_mem, a, sign);
-				number_1_mem = res;
-				//strcpy(number_1, BLANK);
-				convert_system(res, system, number_1);
-					
-				sign = '_';
+				entry = expr_value();								//open parentheses close on their own
+				expr_clear();
+				convert_system(entry, num_system, number_1);
+				state_save(true);
 			}
-						
-			//CLR
-			if (T_X >= 120 && T_X < 180 && T_Y >= 232 && T_Y < 276)
+			remember_ans = 1;
+			cnt = 0;
+			break;
+		}
+		
+		case KEY_NOT:
+		{
+			calc_t inverted = calculate(entry, 0, key.value);			//applies to the number shown, like a sign key
+			
+			if (expr_number(inverted))
 			{
-				print_str(20, 60, 3, WHITE, BLACK, "                ");
-				
-				strcpy(number_1, BLANK);
-				sign = '_';
-				res = 0;
-				number_1_mem = 0;
+				entry = inverted;
+				convert_system(entry, num_system, number_1);
+				remember_ans = 1;
 				cnt = 0;
-				calc = 0;
-				print_calculated = 0;
-				continue;
+			}
+			break;
+		}
+		
+		case KEY_DELETE:
+		{
+			uint8_t digit;
+			
+			if (remember_ans || !cnt)									//only digits being typed
+			{
+				break;
+			}
+			digit = char_to_num(number_1[--cnt]);
+			number_1[cnt] = '_';
+			if (cnt == 1 && number_1[0] == '-')
+			{
+				number_1[--cnt] = '_';
 			}
 			
-			if (!print_calculated)
+			if (cnt)
 			{
-				print_str(20, 60, 3, WHITE, BLACK, "                ");
-					
-				res = convert(system, number_1);
+				entry = calc_undigit(entry, num_system, digit);			//exact, digits past the word never got in
+				expr_number(entry);
 			}
 			else
-			{	
-				print_calculated = 0;
-				res = number_1_mem;
+			{
+				entry = 0;
+				expr_unnumber();
 			}
+			break;
+		}
+		
+		case KEY_WORD:
+		case KEY_SIGN:
+		{
+			if (key.action == KEY_WORD)
+				calc_set_word(key.value, calc_signed);
+			else
+				calc_set_word(calc_bits, !calc_signed);						//the bit pattern stays, only its reading changes
+			entry = calc_norm(entry);
+			convert_system(entry, num_system, number_1);
+			cnt = text_len(number_1);
+			state_save(false);
+			break;
+		}
 		
-			/*if (system != 10)
+		case KEY_MEM:
+		{
+			if (key.value == 'R')
 			{
-				res = convert_system(res, system);
-				system = 10;
-			}*/
+				if (expr_number(memory))									//as if typed in
+				{
+					entry = memory;
+					convert_system(entry, num_system, number_1);
+					remember_ans = 1;
+					cnt = 0;
+				}
+				break;
+			}
 			
-//			sprintf(res_print, "%d", res);
-			for (uint8_t i = 0; i < MAX_CHARS; i++)
+			if (key.value == 'C')
+				memory = 0;
+			else
+				memory = calculate(memory, entry, key.value);
+			state_save(false);
+			break;
+		}
+		
+		case KEY_HIST:
+		{
+			hist_entry_t e;
+			uint8_t pos = key.value == '<' ? hist_pos + 1 : hist_pos - 1;	//PRV goes back, NXT forward
+			
+			if (pos == 0 || !hist_get(pos - 1, &e) || !expr_number(e.value))
+			{
+				break;
+			}
+			hist_pos = pos;
+			entry = e.value;
+			num_system = e.base;										//in the base it was worked out in
+			convert_system(entry, num_system, number_1);
+			remember_ans = 1;
+			cnt = 0;
+			if (readout_on)
 			{
-				if (number_1[i] == '_')
+				readout_labels(num_system);
+			}
+			break;
+		}
+		
+		case KEY_PAGE:
+		{
+			key_page = key_page + 1 < PAD_PAGES ? key_page + 1 : 0;
+			for (uint8_t b = 0; b < BAND_CNT; b++)
+			{
+				if (pgm_read_byte(&bands[b].pages) > 1)
 				{
-					res_print[i] = 0;
-					break;
+					draw_labels(b);
 				}
-				res_print[i] = number_1[i];
-				
 			}
-			//strcpy(res_print, number_1);
-			print_str(20, 60, 3, WHITE, BLACK, res_print);
+			break;
+		}
 		
+		case KEY_CLEAR:
+		{
+			strcpy_P(number_1, PSTR(BLANK));
+			expr_clear();
+			entry = 0;
+			calc_clear_status();
+			cnt = 0;
+			break;
 		}
-    }
+	}
+	
+	frame_dirty = true;													//drawn by the render task, with whatever else comes in before it
+	PROF_END(KEY_PRESS);
 }
 
+void frame_render(void)
+{
+	value_show(number_1, entry);
+	status_show(false);
+	frame_dirty = false;
+}
+
+#define BOOT_PAD 1				//bands[] index of the pad, drawn before touches are taken
+
+uint8_t boot_stage = 0;
+
+bool boot_step(void)														//next piece of the first screen: the other bands, then the result area, false once all is up
+{
+	uint8_t b = boot_stage < BOOT_PAD ? boot_stage : boot_stage + 1;
+	
+	if (b < BAND_CNT)
+	{
+		draw_band(b, true);
+	}
+	else
+	{
+		fill_rect(0, MENU_H + 1, MAX_X, PAD_Y - MENU_H - 1, BLACK);
+		fields_blank();
+		value_show(number_1, entry);
+		status_show(true);
+	}
+	
+	return ++boot_stage < BAND_CNT;
+}
+
+void boot_pad(void)
+{
+	draw_band(BOOT_PAD, true);
+}
+
+/*tasks*/
+#define TASK_KEYS 0
+#define TASK_BOOT 1
+#define TASK_RENDER 2
+#define TASK_PERSIST 3
+#define RENDER_TICKS 20				//at most 50 frames a second, keys in between share one
+/*end tasks*/
+
+void task_keys(void)														//every queued touch, a slow frame leaves none behind
+{
+	touch_event_t ev;
+	unsigned int t_x, t_y;
+	
+	while (input_pop(&ev))
+	{
+		calib_apply(ev.x, ev.y, &t_x, &t_y);
+		key_press(key_at(t_x, t_y), ev.type);
+	}
+}
+
+void task_boot(void)														//one piece per run, touches in between go first
+{
+	if (boot_step())
+	{
+		sched_post(TASK_BOOT);
+	}
+}
+
+void task_render(void)
+{
+	if (frame_dirty)
+	{
+		frame_render();
+	}
+	if (overlay_left && --overlay_left == 0)
+	{
+		overlay_restore();
+	}
+}
+
+void task_persist(void)
+{
+	hist_poll();
+}
+
+const task_t tasks[] = {
+	{task_keys, 1},
+	{task_boot, 0},
+	{task_render, RENDER_TICKS},
+	{task_persist, 1}
+};
+
+int main(void)
+{
+	init();
+	
+	hist_state_t state;
+	
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	sei();
+	
+	if (!calib_load() || touch_pressed())									//first boot, or screen held down at power on
+	{
+		calibrate();
+	}
+	
+	if (hist_load(&state))													//carry on from where the last session was
+	{
+		entry = state.value;
+		memory = state.memory;
+		num_system = state.base;
+		calc_set_word(state.bits, state.is_signed);
+		convert_system(entry, num_system, number_1);
+		remember_ans = 1;
+	}
+	
+	boot_pad();
+	sched_init(tasks, sizeof(tasks) / sizeof(tasks[0]));
+	sched_post(TASK_BOOT);
+	sched_run();
+}
@@ -0,0 +1,102 @@
+/*
+ * prof.c
+ * Timer1 setup and the USART dump for the profiling zones in prof.h.
+ * TXD is PD1, the touch clock, so the touch tick is held off while the
+ * ring is sent and the pin goes back to the port afterwards. RXD stays off.
+ */ 
+#ifndef NDEBUG
+
+#ifndef F_CPU
+#define F_CPU 7372800UL
+#endif
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <stdint.h>
+#include "prof.h"
+
+prof_entry_t prof_ring[PROF_RING];
+uint8_t prof_head = 0;
+
+static void prof_clear(void)
+{
+	uint8_t i;
+	
+	for (i = 0; i < PROF_RING; i++)
+	{
+		prof_ring[i].zone = PROF_EMPTY;
+	}
+	prof_head = 0;
+}
+
+void prof_init(void)
+{
+	prof_clear();
+	TCCR1A = 0;
+	TCCR1B = _BV(CS11) | _BV(CS10);										//normal mode, clk / 64
+}
+
+static void prof_putc(char c)
+{
+	while (!(UCSRA & _BV(UDRE)));
+	UDR = c;
+}
+
+static void prof_hex(uint16_t v, uint8_t digits)
+{
+	while (digits--)
+	{
+		uint8_t d = (v >> (digits * 4)) & 0x0f;
+		prof_putc(d < 10 ? '0' + d : 'A' - 10 + d);
+	}
+}
+
+static void prof_puts(const char *s)
+{
+	while (*s)
+	{
+		prof_putc(*s++);
+	}
+}
+
+/*
+ * PROF, then one line per mark, oldest first: B or E, zone id, ticks, all hex.
+ * END closes the dump. The ring is emptied once it has been sent.
+ */
+void prof_dump(void)
+{
+	uint8_t timsk = TIMSK, i, k;
+	
+	TIMSK &= ~_BV(OCIE0);
+	
+	UBRRH = 0;
+	UBRRL = F_CPU / 16 / PROF_BAUD - 1;									//exact at 7.3728 MHz
+	UCSRC = _BV(URSEL) | _BV(UCSZ1) | _BV(UCSZ0);						//8N1
+	UCSRA = _BV(TXC);
+	UCSRB = _BV(TXEN);
+	
+	prof_puts("PROF\n");
+	for (i = 0; i < PROF_RING; i++)
+	{
+		k = (prof_head + i) & (PROF_RING - 1);
+		if (prof_ring[k].zone == PROF_EMPTY)
+		{
+			continue;
+		}
+		prof_putc(prof_ring[k].zone & PROF_END_FLAG ? 'E' : 'B');
+		prof_putc(' ');
+		prof_hex(prof_ring[k].zone & ~PROF_END_FLAG, 2);
+		prof_putc(' ');
+		prof_hex(prof_ring[k].t, 4);
+		prof_putc('\n');
+	}
+	prof_puts("END\n");
+	
+	while (!(UCSRA & _BV(TXC)));										//last stop bit out before the pin goes back
+	UCSRB = 0;
+	
+	prof_clear();
+	TIMSK = timsk;
+}
+
+#endif
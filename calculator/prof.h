@@ -0,0 +1,76 @@
+/*
+ * prof.h
+ * Profiling zones for Debug builds: Timer1 timestamps in an SRAM ring,
+ * sent over USART when asked for. Release builds (NDEBUG) drop all of it.
+ */ 
+#ifndef PROF_H_
+#define PROF_H_
+
+#include <stdint.h>
+
+/*zones, tools/prof_report.py reads the names from here*/
+#define PROF_ZONES \
+	ZONE(TOUCH_READ, "touch_read_xy") \
+	ZONE(KEY_PRESS, "key_press") \
+	ZONE(DRAW_CALC, "draw_calc") \
+	ZONE(PRINT_STR, "print_str") \
+	ZONE(RENDER_FLUSH, "render_flush") \
+	ZONE(CONVERT_SYSTEM, "convert_system")
+/*end zones*/
+
+enum
+{
+#define ZONE(id, name) PROF_##id,
+	PROF_ZONES
+#undef ZONE
+	PROF_CNT
+};
+
+#define PROF_RING 64			//entries, power of two, the oldest are overwritten
+#define PROF_PRESCALE 64		//Timer1 at F_CPU / 64, 8.68 us a tick, wraps after 569 ms
+#define PROF_BAUD 115200
+#define PROF_END_FLAG 0x80
+#define PROF_EMPTY 0xff
+
+#ifdef NDEBUG
+
+#define PROF_INIT()
+#define PROF_BEGIN(zone)
+#define PROF_END(zone)
+
+#else
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+typedef struct
+{
+	uint8_t zone;				//zone id, PROF_END_FLAG set on the closing mark
+	uint16_t t;					//TCNT1
+} prof_entry_t;
+
+extern prof_entry_t prof_ring[PROF_RING];
+extern uint8_t prof_head;
+
+static inline void prof_mark(uint8_t zone)		//a few cycles, interrupts off so the ISR zones can't tear TCNT1 or the ring
+{
+	uint8_t sreg = SREG, i;
+	
+	cli();
+	i = prof_head;
+	prof_ring[i].t = TCNT1;
+	prof_ring[i].zone = zone;
+	prof_head = (i + 1) & (PROF_RING - 1);
+	SREG = sreg;
+}
+
+void prof_init(void);
+void prof_dump(void);
+
+#define PROF_INIT() prof_init()
+#define PROF_BEGIN(zone) prof_mark(PROF_##zone)
+#define PROF_END(zone) prof_mark(PROF_##zone | PROF_END_FLAG)
+
+#endif
+
+#endif /* PROF_H_ */
@@ -0,0 +1,76 @@
+/*
+ * sched.c
+ * Due flags are set from the tick and cleared by the loop, so both sides
+ * change them with interrupts off.
+ */ 
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include "sched.h"
+
+static const task_t *task;
+static uint8_t task_cnt = 0;
+static uint16_t left[SCHED_MAX];			//ticks until each periodic task is due
+static volatile uint8_t due = 0;
+
+void sched_init(const task_t *tasks, uint8_t cnt)
+{
+	uint8_t i;
+	
+	task = tasks;
+	task_cnt = cnt;
+	for (i = 0; i < cnt; i++)
+	{
+		left[i] = tasks[i].period;
+	}
+}
+
+void sched_tick(void)
+{
+	uint8_t i;
+	
+	for (i = 0; i < task_cnt; i++)
+	{
+		if (task[i].period && --left[i] == 0)
+		{
+			left[i] = task[i].period;
+			due |= 1 << i;
+		}
+	}
+}
+
+void sched_post(uint8_t i)
+{
+	cli();
+	due |= 1 << i;
+	sei();
+}
+
+void sched_run(void)
+{
+	uint8_t i;
+	
+	while (1)
+	{
+		cli();
+		if (!due)															//checked with interrupts off so a tick can't slip in before sleeping
+		{
+			sleep_enable();
+			sei();
+			sleep_cpu();
+			sleep_disable();
+		}
+		sei();
+		
+		for (i = 0; i < task_cnt; i++)									//one task, then the scan starts over from the top
+		{
+			if (due & (1 << i))
+			{
+				cli();
+				due &= ~(1 << i);
+				sei();
+				task[i].run();
+				break;
+			}
+		}
+	}
+}
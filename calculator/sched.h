@@ -0,0 +1,28 @@
+/*
+ * sched.h
+ * Run to completion scheduler for the UI loop. Tasks are due every period
+ * timer ticks or when posted, the highest one due runs next and the CPU
+ * sleeps when none is.
+ * Calibration, the serial mode and the tape stay modal loops inside the keys
+ * task on purpose: each owns the whole screen and the input while it is open,
+ * so render has nothing to draw, and each polls the EEPROM log itself.
+ */ 
+#ifndef SCHED_H_
+#define SCHED_H_
+
+#include <stdint.h>
+
+#define SCHED_MAX 8				//due flags are one byte
+
+typedef struct
+{
+	void (*run)(void);
+	uint16_t period;			//ticks, 0 runs only when posted
+} task_t;
+
+void sched_init(const task_t *tasks, uint8_t cnt);	//first task has the highest priority
+void sched_tick(void);								//from the timer interrupt
+void sched_post(uint8_t task);
+void sched_run(void) __attribute__((noreturn));
+
+#endif /* SCHED_H_ */
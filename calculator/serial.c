@@ -0,0 +1,194 @@
+/*
+ * serial.c
+ * USART transport behind serial.h. The receive ISR fills one line while the
+ * UI loop works on the other; the send ISR drains one reply while the next
+ * is being written.
+ */ 
+#ifndef F_CPU
+#define F_CPU 7372800UL
+#endif
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "serial.h"
+
+#define RX_NONE 0xff
+
+/*
+ * A line that ends while the UI loop still has the other one stays in the
+ * fill buffer as the held line. Lines that end while one is held are only
+ * counted, against the held buffer, and come back as SERIAL_OVERRUN after
+ * it, so every line gets exactly one reply and in order.
+ */
+static char rx[2][SERIAL_LINE];
+static uint8_t rx_fill = 0, rx_pos = 0;			//ISR side
+static bool rx_long = false, rx_drop = false;	//line in progress ran past the buffer, or is being counted as lost
+static volatile uint8_t rx_ready = RX_NONE;		//line waiting for the UI loop
+static volatile bool rx_held = false;			//rx_fill has a whole line too
+static volatile uint8_t rx_lost[2];				//lines dropped after each buffer's line
+static uint8_t lost = 0;						//UI side, overrun markers still owed
+static char overrun[2] = {SERIAL_OVERRUN, 0};
+
+static char tx[2][SERIAL_REPLY];
+static volatile uint8_t tx_len[2] = {0, 0};		//0 while the buffer is free
+static uint8_t tx_put = 0;						//UI side
+static volatile uint8_t tx_cur = 0, tx_pos = 0;	//ISR side
+static uint8_t timsk;
+static bool tx_used;
+
+void serial_open(void)
+{
+	timsk = TIMSK;
+	TIMSK &= ~_BV(OCIE0);												//touch tick off, its pins become RXD and TXD
+	
+	rx_fill = rx_pos = 0;
+	rx_long = rx_drop = false;
+	rx_ready = RX_NONE;
+	rx_held = false;
+	rx_lost[0] = rx_lost[1] = 0;
+	lost = 0;
+	tx_len[0] = tx_len[1] = 0;
+	tx_put = tx_cur = tx_pos = 0;
+	tx_used = false;
+	
+	UBRRH = 0;
+	UBRRL = F_CPU / 16 / SERIAL_BAUD - 1;								//exact at 7.3728 MHz
+	UCSRC = _BV(URSEL) | _BV(UCSZ1) | _BV(UCSZ0);						//8N1
+	UCSRB = _BV(RXCIE) | _BV(RXEN) | _BV(TXEN);
+}
+
+void serial_close(void)
+{
+	while (tx_len[0] || tx_len[1]);
+	while (tx_used && !(UCSRA & _BV(TXC)));								//last stop bit out before the pins go back
+	
+	UCSRB = 0;
+	TIMSK = timsk;
+}
+
+char *serial_line(void)
+{
+	if (lost)
+	{
+		return overrun;
+	}
+	return rx_ready == RX_NONE ? 0 : rx[rx_ready];
+}
+
+void serial_line_done(void)
+{
+	if (lost)
+	{
+		lost--;
+		return;
+	}
+	
+	cli();
+	lost = rx_lost[rx_ready];											//dropped after this line, owed before the next
+	rx_lost[rx_ready] = 0;
+	if (rx_held)														//the held line is next, its buffer stops being filled
+	{
+		rx_ready = rx_fill;
+		rx_fill ^= 1;
+		rx_held = false;
+	}
+	else
+	{
+		rx_ready = RX_NONE;
+	}
+	sei();
+}
+
+char *serial_reply(void)
+{
+	while (tx_len[tx_put]);
+	return tx[tx_put];
+}
+
+void serial_send(uint8_t len)
+{
+	if (!len)
+	{
+		return;
+	}
+	tx_len[tx_put] = len;
+	tx_put ^= 1;
+	tx_used = true;
+	UCSRB |= _BV(UDRIE);
+}
+
+ISR(USART_RXC_vect)
+{
+	char c = UDR;
+	
+	if (c == '\r')
+	{
+		return;
+	}
+	
+	if (!rx_drop && rx_held)											//no room for this line, counted when it starts
+	{
+		rx_drop = true;
+		if (rx_lost[rx_fill] < 0xff)
+		{
+			rx_lost[rx_fill]++;
+		}
+	}
+	
+	if (c == '\n')
+	{
+		if (!rx_drop)
+		{
+			if (rx_long)
+			{
+				rx[rx_fill][0] = SERIAL_LONG;
+				rx_pos = 1;
+			}
+			rx[rx_fill][rx_pos] = 0;
+			if (rx_ready == RX_NONE)
+			{
+				rx_ready = rx_fill;
+				rx_fill ^= 1;
+			}
+			else
+			{
+				rx_held = true;
+			}
+		}
+		rx_pos = 0;
+		rx_long = rx_drop = false;
+		return;
+	}
+	
+	if (rx_drop)
+	{
+		return;
+	}
+	if (rx_pos < SERIAL_LINE - 1)
+	{
+		rx[rx_fill][rx_pos++] = c;
+	}
+	else
+	{
+		rx_long = true;
+	}
+}
+
+ISR(USART_UDRE_vect)
+{
+	UDR = tx[tx_cur][tx_pos++];
+	
+	if (tx_pos == tx_len[tx_cur])
+	{
+		tx_len[tx_cur] = 0;
+		tx_pos = 0;
+		tx_cur ^= 1;
+		if (!tx_len[tx_cur])
+		{
+			UCSRB &= ~_BV(UDRIE);
+			UCSRA = _BV(TXC);											//clear, so it sets once this last byte is out
+		}
+	}
+}
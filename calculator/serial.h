@@ -0,0 +1,29 @@
+/*
+ * serial.h
+ * Line based USART transport for the serial mode, interrupt driven with two
+ * receive lines and two reply buffers so one can be worked on while the
+ * other is in flight. RXD and TXD are the touch IRQ and clock pins, so the
+ * touch tick is off while the port is open.
+ */ 
+#ifndef SERIAL_H_
+#define SERIAL_H_
+
+#include <stdint.h>
+
+#define SERIAL_BAUD 115200
+#define SERIAL_LINE 136			//b:~ and two 64 digit binary operands around & ~, with the terminator
+
+/*line markers, in place of the text of a line that can't be evaluated*/
+#define SERIAL_LONG 0x01			//longer than SERIAL_LINE, nothing of it is kept
+#define SERIAL_OVERRUN 0x02			//came in while both line buffers were full
+/*end line markers*/
+#define SERIAL_REPLY 136			//four bases of a 64 bit word and the separators
+
+void serial_open(void);
+void serial_close(void);			//waits for the last reply to go out
+char *serial_line(void);			//a complete line or a marker, 0 while none is waiting, one per line received
+void serial_line_done(void);		//hands the line's buffer back to the receiver
+char *serial_reply(void);			//free reply buffer, waits for one if both are queued
+void serial_send(uint8_t len);		//queues what was written into serial_reply()
+
+#endif /* SERIAL_H_ */
@@ -0,0 +1,58 @@
+/*
+ * eeprom_sim.c
+ * Write timing behind include/avr/eeprom.h, one sim tick is a millisecond,
+ * and an image file so the EEPROM outlasts a run.
+ */ 
+#include <stdio.h>
+#include "sim.h"
+
+extern uint8_t __start_sim_eeprom[], __stop_sim_eeprom[];	//the linker's bounds of the EEMEM section
+
+unsigned int sim_eeprom_ms = 9;
+unsigned int sim_eeprom_busy = 0;
+
+void sim_eeprom_write(uint8_t *addr, uint8_t value, bool always)	//update skips a byte that already holds the value, as the AVR libc one does
+{
+	if (always || *addr != value)
+	{
+		*addr = value;
+		sim_eeprom_busy = sim_eeprom_ms;
+	}
+}
+
+void sim_eeprom_tick(void)
+{
+	if (sim_eeprom_busy)
+	{
+		sim_eeprom_busy--;
+	}
+}
+
+bool sim_eeprom_load(const char *path)
+{
+	FILE *f = fopen(path, "rb");
+	size_t n = __stop_sim_eeprom - __start_sim_eeprom;
+	bool ok;
+	
+	if (!f)
+	{
+		return false;
+	}
+	ok = fread(__start_sim_eeprom, 1, n, f) == n;
+	fclose(f);
+	return ok;
+}
+
+bool sim_eeprom_save(const char *path)
+{
+	FILE *f = fopen(path, "wb");
+	size_t n = __stop_sim_eeprom - __start_sim_eeprom;
+	bool ok;
+	
+	if (!f)
+	{
+		return false;
+	}
+	ok = fwrite(__start_sim_eeprom, 1, n, f) == n;
+	return fclose(f) == 0 && ok;
+}
@@ -0,0 +1,58 @@
+/*
+ * expr_test.c
+ * Host check of the expression engine in expr.c: a number taken back out
+ * with backspace, with and without the implicit multiply in front of it.
+ */ 
+#include <stdio.h>
+#include "../expr.h"
+
+static int failed = 0;
+
+static void expect(bool ok, calc_t want, const char *what)
+{
+	calc_t got = expr_value();
+	
+	if (!ok || got != want)
+	{
+		printf("expr_test: %s gives %lld, want %lld\n", what, (long long)got, (long long)want);
+		failed = 1;
+	}
+	expr_clear();
+}
+
+int main(void)
+{
+	bool ok;
+	
+	calc_set_word(32, true);
+	
+	ok = expr_open() && expr_number(2) && expr_op('+') && expr_number(3) && expr_close();	//(2+3)4, 4 deleted, then +1
+	ok = ok && expr_number(4);
+	expr_unnumber();
+	ok = ok && expr_op('+') && expr_number(1);
+	expect(ok, 6, "(2+3) + 1 after deleting 4");
+	
+	ok = expr_number(2) && expr_op('x') && expr_open() && expr_number(3) && expr_close();		//the x in front of ( was popped by the implicit one
+	ok = ok && expr_number(5);
+	expr_unnumber();
+	ok = ok && expr_op('|') && expr_number(8);
+	expect(ok, 14, "2x(3) | 8 after deleting 5");
+	
+	ok = expr_open() && expr_number(2) && expr_close() && expr_number(5);					//typed again, the multiply comes back
+	expr_unnumber();
+	ok = ok && expr_number(7);
+	expect(ok, 14, "(2)7 after deleting 5");
+	
+	ok = expr_open() && expr_open() && expr_number(1) && expr_op('+') && expr_number(1) && expr_close() && expr_number(5);	//)x left behind would refuse the )
+	expr_unnumber();
+	ok = ok && expr_close() && expr_op('x') && expr_number(3);
+	expect(ok, 6, "((1+1)) x 3 after deleting 5");
+	
+	ok = expr_number(9) && expr_op('-') && expr_number(4);								//explicit operator stays
+	expr_unnumber();
+	ok = ok && expr_number(1);
+	expect(ok, 8, "9-1 after deleting 4");
+	
+	puts(failed ? "expr_test: FAIL" : "expr_test: ok");
+	return failed;
+}
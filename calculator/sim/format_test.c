@@ -0,0 +1,141 @@
+/*
+ * format_test.c
+ * Host check of the number formatter and parser in calculatorFunc.c against
+ * the C library, every base at every word size, signed and unsigned: edge
+ * values and a run of pseudo random ones, typed and deleted digit by digit.
+ */ 
+#include <stdio.h>
+#include <string.h>
+#include "../calculatorFunc.h"
+
+#define RANDOM_VALUES 20000
+
+static const uint8_t word_bits[] = {8, 16, 32, 64};
+static const int bases[] = {2, 8, 10, 16};
+
+static int failed = 0;
+static uint64_t lcg = 0x2545F4914F6CDD1DULL;
+
+static uint64_t next_random(void)
+{
+	lcg = lcg * 6364136223846793005ULL + 1442695040888963407ULL;
+	return lcg ^ (lcg >> 29);
+}
+
+static void reference(calc_t v, int base, char *out)					//what the formatter should write, without the end marker
+{
+	uint64_t mask = calc_bits == 64 ? UINT64_MAX : ((uint64_t)1 << calc_bits) - 1;
+	uint64_t u = (uint64_t)v & mask;
+	char bin[65];
+	int i = 64;
+	
+	if (base == 10)
+	{
+		sprintf(out, calc_signed ? "%lld" : "%llu", calc_signed ? (long long)v : (unsigned long long)u);
+		return;
+	}
+	if (base == 8 || base == 16)
+	{
+		sprintf(out, base == 8 ? "%llo" : "%llX", (unsigned long long)u);
+		return;
+	}
+	
+	bin[i] = 0;
+	do
+	{
+		bin[--i] = '0' + (u & 1);
+		u >>= 1;
+	}
+	while (u);
+	strcpy(out, bin + i);
+}
+
+static void check(calc_t raw, int base)
+{
+	char got[NUM_CHARS + 2], want[NUM_CHARS + 2];
+	calc_t v = calc_norm(raw), typed = 0, prefix[NUM_CHARS + 1];
+	uint8_t len;
+	int i;
+	
+	convert_system(v, base, got);
+	len = strchr(got, '_') - got;
+	got[len] = 0;
+	reference(v, base, want);
+	if (strcmp(got, want) != 0)
+	{
+		printf("format_test: %s%d base %d: got %s, want %s\n", calc_signed ? "INT" : "UINT", calc_bits, base, got, want);
+		failed = 1;
+		return;
+	}
+	
+	got[len] = '_';
+	calc_clear_status();
+	if (convert(base, got) != v || calc_status)
+	{
+		printf("format_test: %s%d base %d: %s does not parse back\n", calc_signed ? "INT" : "UINT", calc_bits, base, want);
+		failed = 1;
+	}
+	
+	if (want[0] == '-')													//the keypad has no minus key, negatives only come from results
+	{
+		return;
+	}
+	for (i = 0; i < len; i++)												//typed a digit at a time, as the keypad does
+	{
+		prefix[i] = typed;
+		typed = calc_digit(typed, base, char_to_num(want[i]));
+	}
+	if (typed != v || calc_status)
+	{
+		printf("format_test: %s%d base %d: %s typed gives %lld\n", calc_signed ? "INT" : "UINT", calc_bits, base, want, (long long)typed);
+		failed = 1;
+		return;
+	}
+	
+	for (i = len - 1; i > 0; i--)											//and deleted again, each step back where typing was
+	{
+		typed = calc_undigit(typed, base, char_to_num(want[i]));
+		if (typed != prefix[i])
+		{
+			printf("format_test: %s%d base %d: %s deleted to %d digits gives %lld\n", calc_signed ? "INT" : "UINT", calc_bits, base, want, i, (long long)typed);
+			failed = 1;
+			return;
+		}
+	}
+}
+
+int main(void)
+{
+	uint8_t w, b, s, k;
+	long n;
+	
+	for (s = 0; s < 2; s++)
+	{
+		for (w = 0; w < sizeof(word_bits); w++)
+		{
+			calc_set_word(word_bits[w], s == 0);
+			
+			for (b = 0; b < sizeof(bases) / sizeof(bases[0]); b++)
+			{
+				for (k = 0; k < 64; k++)										//powers of two and their neighbours, the edges of every digit count
+				{
+					check((calc_t)((uint64_t)1 << k), bases[b]);
+					check((calc_t)(((uint64_t)1 << k) - 1), bases[b]);
+					check(-(calc_t)((uint64_t)1 << k), bases[b]);
+				}
+				check(0, bases[b]);
+				check(INT64_MAX, bases[b]);
+				check(INT64_MIN, bases[b]);
+				check(9999999999999999999ULL, bases[b]);
+				
+				for (n = 0; n < RANDOM_VALUES; n++)
+				{
+					check((calc_t)(next_random() >> (next_random() & 63)), bases[b]);
+				}
+			}
+		}
+	}
+	
+	puts(failed ? "format_test: FAIL" : "format_test: ok");
+	return failed;
+}
@@ -0,0 +1,126 @@
+/*
+ * hist_test.c
+ * Host check of the EEPROM log in hist.c: ring wrap, sequence wrap, reload,
+ * and reads while records are still queued or half written.
+ */ 
+#include <stdio.h>
+#include <avr/eeprom.h>
+#include "../hist.h"
+#include "sim.h"
+
+static int failed = 0;
+
+static void expect(bool cond, const char *what, long long got)
+{
+	if (!cond)
+	{
+		printf("hist_test: %s (%lld)\n", what, got);
+		failed = 1;
+	}
+}
+
+static void flush(void)													//ticks pass until everything queued is in the log
+{
+	while (hist_poll())
+	{
+		while (!eeprom_is_ready())
+		{
+			sim_eeprom_tick();
+		}
+	}
+}
+
+static void answer(calc_t v)
+{
+	hist_state_t s = {0};
+	
+	s.value = v;
+	s.memory = -v;
+	s.base = 10;
+	s.bits = 32;
+	s.is_signed = true;
+	s.op = '+';
+	hist_save(&s, true);
+}
+
+int main(void)
+{
+	hist_state_t r;
+	hist_entry_t e;
+	int i, j;
+	
+	sim_eeprom_ms = 0;
+	expect(!hist_load(&r), "empty log loaded", 0);
+	
+	for (i = 1; i <= 300; i++)											//past the ring and the 8 bit sequence a few times
+	{
+		if (i % 3)
+		{
+			answer(i);
+		}
+		else
+		{
+			hist_state_t s = {0};
+			
+			s.value = i;
+			s.memory = -i;
+			hist_save(&s, false);
+		}
+		flush();
+		
+		if (i % 37 == 0)
+		{
+			expect(hist_load(&r) && r.value == i && r.memory == -i, "reload lost the newest state", r.value);
+			for (j = 0; j < HIST_KEEP; j++)
+			{
+				expect(hist_get(j, &e) && e.value % 3 && e.value <= i && e.value > i - 13, "reload lost an answer", e.value);
+				expect(hist_read(j, &e) && e.value % 3 && e.value <= i && e.value > i - 13, "log lost an answer", e.value);
+			}
+		}
+	}
+	
+	sim_eeprom_ms = 9;													//as slow as the part, reads must see records not written yet
+	answer(1001);
+	flush();
+	answer(1002);
+	for (i = 0; i < 5; i++)												//half of 1002 is out
+	{
+		hist_poll();
+		while (!eeprom_is_ready())
+		{
+			sim_eeprom_tick();
+		}
+	}
+	answer(1003);
+	
+	for (j = 0; j < 2; j++)												//while queued, then once written
+	{
+		expect(hist_read(0, &e) && e.value == 1003, "queued answer not read", e.value);
+		expect(hist_read(1, &e) && e.value == 1002, "answer going out not read", e.value);
+		expect(hist_read(2, &e) && e.value == 1001, "logged answer not read", e.value);
+		flush();
+	}
+	expect(hist_load(&r) && r.value == 1003, "reload after the slow writes", r.value);
+	
+	for (j = 0; j < 2; j++)												//a state saved behind a queued answer, with a record going out and without
+	{
+		hist_state_t s = {0};
+		
+		if (j == 0)
+		{
+			answer(1100);
+			hist_poll();
+		}
+		answer(1101 + j);
+		s.value = 1200 + j;
+		s.base = 16;
+		hist_save(&s, false);
+		expect(hist_read(0, &e) && e.value == 1101 + j && e.base == 10, "answer lost to the state after it", e.value);
+		flush();
+		expect(hist_read(0, &e) && e.value == 1101 + j && e.base == 10, "answer not logged before the state", e.value);
+		expect(hist_load(&r) && r.value == 1200 + j && r.base == 16, "state after the answer not logged", r.value);
+	}
+	
+	puts(failed ? "hist_test: FAIL" : "hist_test: ok");
+	return failed;
+}
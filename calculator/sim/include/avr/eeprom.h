@@ -0,0 +1,23 @@
+/*
+ * Host stand-in for avr/eeprom.h, EEMEM variables are plain memory.
+ * A byte write keeps the EEPROM busy for sim_eeprom_ms ticks, as the real
+ * one is for about 8.5 ms; the block calls stay instant.
+ */ 
+#ifndef SIM_EEPROM_H_
+#define SIM_EEPROM_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define EEMEM __attribute__((section("sim_eeprom")))	//kept together, so -e can load and save them as one image
+
+#define eeprom_read_byte(addr) (*(const uint8_t *)(addr))
+#define eeprom_read_word(addr) (*(const uint16_t *)(addr))
+#define eeprom_write_byte(addr, value) sim_eeprom_write((uint8_t *)(addr), (value), true)
+#define eeprom_update_byte(addr, value) sim_eeprom_write((uint8_t *)(addr), (value), false)
+#define eeprom_update_word(addr, value) (*(uint16_t *)(addr) = (value))
+#define eeprom_read_block(dst, src, n) memcpy((dst), (src), (n))
+#define eeprom_update_block(src, dst, n) memcpy((dst), (src), (n))
+#define eeprom_is_ready() (sim_eeprom_busy == 0)
+
+#endif /* SIM_EEPROM_H_ */
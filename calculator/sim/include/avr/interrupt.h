@@ -0,0 +1,11 @@
+/*
+ * Host stand-in for avr/interrupt.h, the simulator calls handlers itself.
+ */ 
+#ifndef SIM_INTERRUPT_H_
+#define SIM_INTERRUPT_H_
+
+#define sei()
+#define cli()
+#define ISR(vector) void vector(void)
+
+#endif /* SIM_INTERRUPT_H_ */
@@ -0,0 +1,24 @@
+/*
+ * Host stand-in for avr/io.h, only the USART and timer mask registers that
+ * serial_test.c drives; whoever includes it defines them.
+ */ 
+#ifndef SIM_IO_H_
+#define SIM_IO_H_
+
+#include <stdint.h>
+
+extern volatile uint8_t UDR, UCSRA, UCSRB, UCSRC, UBRRH, UBRRL, TIMSK;
+
+#define _BV(bit) (1 << (bit))
+
+#define OCIE0 1
+#define RXCIE 7
+#define UDRIE 5
+#define RXEN 4
+#define TXEN 3
+#define TXC 6
+#define URSEL 7
+#define UCSZ1 2
+#define UCSZ0 1
+
+#endif /* SIM_IO_H_ */
@@ -0,0 +1,37 @@
+/*
+ * Host stand-in for avr/pgmspace.h, flash is ordinary memory here.
+ */ 
+#ifndef SIM_PGMSPACE_H_
+#define SIM_PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) sim_read_word(addr)
+#define pgm_read_dword(addr) sim_read_dword(addr)
+
+static inline uint16_t sim_read_word(const void *addr)		//by bytes, like the lpm reads, so any object can be read
+{
+	uint16_t w;
+	memcpy(&w, addr, sizeof(w));
+	return w;
+}
+
+static inline uint32_t sim_read_dword(const void *addr)
+{
+	uint32_t d;
+	memcpy(&d, addr, sizeof(d));
+	return d;
+}
+
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strcmp_P strcmp
+
+#endif /* SIM_PGMSPACE_H_ */
@@ -0,0 +1,17 @@
+/*
+ * Host stand-in for avr/sleep.h, sleeping advances simulated time by one tick.
+ */ 
+#ifndef SIM_SLEEP_H_
+#define SIM_SLEEP_H_
+
+void sim_idle(void);
+
+#define SLEEP_MODE_IDLE 0
+#define SLEEP_MODE_PWR_DOWN 2
+
+#define set_sleep_mode(mode)
+#define sleep_enable()
+#define sleep_disable()
+#define sleep_cpu() sim_idle()
+
+#endif /* SIM_SLEEP_H_ */
@@ -0,0 +1,11 @@
+/*
+ * Host stand-in for util/delay.h, busy waits return at once and are only
+ * added up, for the boot report in sim.c.
+ */ 
+#ifndef SIM_DELAY_H_
+#define SIM_DELAY_H_
+
+#define _delay_ms(ms) ((void)(sim_busy_ms += (ms)))
+#define _delay_us(us) ((void)(sim_busy_ms += (us) / 1000.0))
+
+#endif /* SIM_DELAY_H_ */
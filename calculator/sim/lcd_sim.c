@@ -0,0 +1,152 @@
+/*
+ * lcd_sim.c
+ * SSD1289 model behind lcd.h: registers that main.c uses, a 240x320 GRAM and the
+ * vertical scroll.
+ */ 
+#include <stdio.h>
+#include <stdint.h>
+#include <util/delay.h>
+#include "../lcd.h"
+#include "sim.h"
+
+#define GRAM_W 240
+#define GRAM_H 320
+
+unsigned long sim_lcd_cmds = 0, sim_lcd_data = 0, sim_lcd_reads = 0;
+
+static uint16_t gram[GRAM_H][GRAM_W];
+static uint16_t reg[0x100];
+static uint8_t index_reg = 0;
+static unsigned int ac_x = 0, ac_y = 0;		//address counter
+
+static void ac_step(void)					//entry mode R11h: ID bits assumed set (increment), AM picks the direction
+{
+	unsigned int hsa = reg[0x44] & 0xff, hea = reg[0x44] >> 8;
+	unsigned int vsa = reg[0x45], vea = reg[0x46];
+	
+	if (reg[0x11] & 0x0008)
+	{
+		if (++ac_y > vea)
+		{
+			ac_y = vsa;
+			if (++ac_x > hea) ac_x = hsa;
+		}
+	}
+	else
+	{
+		if (++ac_x > hea)
+		{
+			ac_x = hsa;
+			if (++ac_y > vea) ac_y = vsa;
+		}
+	}
+}
+
+static void gram_write(uint16_t colour)
+{
+	if (ac_x < GRAM_W && ac_y < GRAM_H)
+	{
+		gram[ac_y][ac_x] = colour;
+	}
+	ac_step();
+}
+
+void LCD_reset(void)
+{
+	_delay_ms(10);														//as long as lcd.c holds reset and waits after it
+	_delay_ms(20);
+	reg[0x11] = 0x6070;
+	reg[0x44] = 0xEF00;
+	reg[0x45] = 0x0000;
+	reg[0x46] = 0x013F;
+}
+
+void LCD_write_cmd(int DH)
+{
+	sim_lcd_cmds++;
+	index_reg = DH;
+}
+
+void LCD_write_data(int DH)
+{
+	sim_lcd_data++;
+	
+	if (index_reg == 0x22)
+	{
+		gram_write(DH);
+		return;
+	}
+	
+	reg[index_reg] = DH;
+	if (index_reg == 0x4E) ac_x = DH;
+	if (index_reg == 0x4F) ac_y = DH;
+}
+
+void LCD_write_color(char hh, char ll)
+{
+	LCD_write_data(((uint8_t)hh << 8) | (uint8_t)ll);
+}
+
+void LCD_burst_begin(void)
+{
+}
+
+void LCD_burst_pixel(unsigned int colour)
+{
+	LCD_write_data(colour);
+}
+
+void LCD_burst_end(void)
+{
+}
+
+void LCD_burst_fill(unsigned int colour, unsigned long count)
+{
+	while (count--)
+	{
+		LCD_write_data(colour);
+	}
+}
+
+void LCD_read_begin(void)
+{
+	LCD_read_pixel();
+}
+
+unsigned int LCD_read_pixel(void)
+{
+	uint16_t colour = ac_x < GRAM_W && ac_y < GRAM_H ? gram[ac_y][ac_x] : 0;
+	
+	sim_lcd_reads++;
+	ac_step();
+	return colour;
+}
+
+void LCD_read_end(void)
+{
+}
+
+bool sim_lcd_dump(const char *path)		//PPM as the user sees it, the panel is mounted rotated by 180 degrees
+{
+	FILE *f = fopen(path, "wb");
+	int x, y;
+	
+	if (!f)
+	{
+		return false;
+	}
+	
+	fprintf(f, "P6\n%d %d\n255\n", GRAM_W, GRAM_H);
+	for (y = GRAM_H - 1; y >= 0; y--)
+	{
+		for (x = GRAM_W - 1; x >= 0; x--)
+		{
+			uint16_t c = gram[(y + reg[0x41]) % GRAM_H][x];		//R41h scroll, the first screen is the whole panel as init sets R48h-R49h
+			fputc(((c >> 11) & 0x1f) * 255 / 31, f);
+			fputc(((c >> 5) & 0x3f) * 255 / 63, f);
+			fputc((c & 0x1f) * 255 / 31, f);
+		}
+	}
+	
+	return fclose(f) == 0;
+}
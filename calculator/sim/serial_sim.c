@@ -0,0 +1,80 @@
+/*
+ * serial_sim.c
+ * USART behind serial.h: lines come from the script's serial commands, replies go to stdout.
+ */ 
+#include <stdio.h>
+#include <string.h>
+#include "../serial.h"
+#include "sim.h"
+
+#define SIM_LINES 16
+
+static char lines[SIM_LINES][SERIAL_LINE];
+static unsigned int head = 0, tail = 0;
+static char reply[SERIAL_REPLY];
+static bool shown = false;				//current line already echoed
+
+void sim_serial_queue(const char *text)
+{
+	if ((head + 1) % SIM_LINES == tail)
+	{
+		fprintf(stderr, "sim: serial queue full, dropped %s\n", text);
+		return;
+	}
+	
+	if (strlen(text) >= SERIAL_LINE)										//the receiver keeps only the marker
+	{
+		lines[head][0] = SERIAL_LONG;
+		lines[head][1] = 0;
+	}
+	else
+	{
+		strcpy(lines[head], text);
+	}
+	head = (head + 1) % SIM_LINES;
+}
+
+bool sim_serial_pending(void)
+{
+	return head != tail;
+}
+
+void serial_open(void)
+{
+	printf("serial: open\n");
+}
+
+void serial_close(void)
+{
+	printf("serial: close\n");
+}
+
+char *serial_line(void)
+{
+	if (head == tail)
+	{
+		return 0;
+	}
+	if (!shown)
+	{
+		printf("serial< %s\n", lines[tail][0] == SERIAL_LONG ? "(long line)" : lines[tail]);
+		shown = true;
+	}
+	return lines[tail];
+}
+
+void serial_line_done(void)
+{
+	tail = (tail + 1) % SIM_LINES;
+	shown = false;
+}
+
+char *serial_reply(void)
+{
+	return reply;
+}
+
+void serial_send(uint8_t len)
+{
+	printf("serial> %.*s", len, reply);
+}
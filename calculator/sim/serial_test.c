@@ -0,0 +1,81 @@
+/*
+ * serial_test.c
+ * Host check of the receive side of serial.c: lines past the buffer, and
+ * lines that come in faster than the UI loop takes them, one reply each.
+ */ 
+#include <stdio.h>
+#include <string.h>
+#include "../serial.c"
+
+volatile uint8_t UDR, UCSRA, UCSRB, UCSRC, UBRRH, UBRRL, TIMSK;
+
+static int failed = 0;
+
+static void receive(const char *text)										//a line down the wire, the RX ISR once a byte
+{
+	while (*text)
+	{
+		UDR = *text++;
+		USART_RXC_vect();
+	}
+	UDR = '\n';
+	USART_RXC_vect();
+}
+
+static void expect(const char *want)										//the next line the UI loop gets, 0 for none
+{
+	char *got = serial_line();
+	
+	if (!want || !got)
+	{
+		if (want || got)
+		{
+			printf("serial_test: got %s, want %s\n", got ? got : "none", want ? want : "none");
+			failed = 1;
+		}
+		return;
+	}
+	if (strcmp(got, want) != 0)
+	{
+		printf("serial_test: got %s, want %s\n", got[0] < ' ' ? "a marker" : got, want[0] < ' ' ? "a marker" : want);
+		failed = 1;
+	}
+	serial_line_done();
+}
+
+int main(void)
+{
+	static const char long_mark[] = {SERIAL_LONG, 0}, overrun_mark[] = {SERIAL_OVERRUN, 0};
+	char text[SERIAL_LINE + 1];
+	
+	serial_open();
+	
+	memset(text, '1', SERIAL_LINE - 1);									//the widest line kept
+	text[SERIAL_LINE - 1] = 0;
+	receive(text);
+	expect(text);
+	text[SERIAL_LINE - 1] = '1';										//one past it
+	text[SERIAL_LINE] = 0;
+	receive(text);
+	expect(long_mark);
+	receive("d:1");														//the line after a long one starts clean
+	expect("d:1");
+	expect(0);
+	
+	receive("d:1");														//UI loop busy with the first, the second is held
+	receive("d:2");
+	receive("d:3");														//both buffers full, these two only counted
+	receive("");
+	expect("d:1");
+	receive("d:4");														//still held, d:2's buffer is the one being read
+	expect("d:2");
+	expect(overrun_mark);												//d:3 and the empty line, in their place
+	expect(overrun_mark);
+	expect("d:4");
+	receive("d:5");
+	expect("d:5");
+	expect(0);
+	
+	puts(failed ? "serial_test: FAIL" : "serial_test: ok");
+	return failed;
+}
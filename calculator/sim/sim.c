@@ -0,0 +1,169 @@
+/*
+ * sim.c
+ * Host build entry: plays a touch script against the firmware and dumps the screen.
+ *
+ *   calc_sim [-e EEPROM.bin] SCRIPT [OUT.ppm]
+ *
+ * -e loads the EEPROM from the image when it exists and writes it back at the
+ * end, so a second run boots calibrated and with the saved state. The first
+ * time the firmware sleeps, the bus writes and busy waits so far are printed
+ * as "ready": with a calibrated EEPROM that is cold boot to the first touch.
+ *
+ * Script lines, coordinates are screen pixels as in keypad.c:
+ *   tap X Y        press for 50 ms, then release for 50 ms
+ *   hold X Y MS    press for MS ms, then release for 50 ms
+ *   wait MS        pen up for MS ms
+ *   shot FILE      write the screen as PPM
+ *   serial TEXT    queue TEXT as a received line for the serial mode
+ *   eeprom MS      EEPROM byte write time from here on, 9 at the start
+ *   # ...          comment
+ */ 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../input.h"
+#include "../sched.h"
+#include "sim.h"
+
+#define TAP_TICKS 50
+#define SETTLE_TICKS 50				//pen up at the end of the script before the final dump
+
+int firmware_main(void);
+
+static FILE *script;
+static const char *out_path;
+static const char *eeprom_path = NULL;
+static unsigned long now = 0;			//ticks since start
+static unsigned long press_end = 0, release_end = 0;
+static unsigned long last_cmds = 0, last_data = 0, last_reads = 0;
+
+double sim_busy_ms = 0;
+
+static void shot(const char *path)
+{
+	if (!sim_lcd_dump(path))
+	{
+		fprintf(stderr, "sim: can't write %s\n", path);
+		exit(1);
+	}
+	printf("%s: t=%lu ms, %lu commands, %lu data words, %lu reads (+%lu, +%lu, +%lu)\n", path, now, sim_lcd_cmds, sim_lcd_data, sim_lcd_reads, sim_lcd_cmds - last_cmds, sim_lcd_data - last_data, sim_lcd_reads - last_reads);
+	last_cmds = sim_lcd_cmds;
+	last_data = sim_lcd_data;
+	last_reads = sim_lcd_reads;
+}
+
+static bool next_line(void)				//start the next timed step, false at the end of the script
+{
+	char line[256], arg[200];
+	unsigned int x, y;
+	unsigned long ms;
+	
+	while (fgets(line, sizeof(line), script))
+	{
+		if (sscanf(line, "tap %u %u", &x, &y) == 2)
+		{
+			ms = TAP_TICKS;
+		}
+		else if (sscanf(line, "hold %u %u %lu", &x, &y, &ms) == 3)
+		{
+		}
+		else if (sscanf(line, "wait %lu", &ms) == 1)
+		{
+			release_end = now + ms;
+			return true;
+		}
+		else if (sscanf(line, "eeprom %lu", &ms) == 1)
+		{
+			sim_eeprom_ms = ms;
+			continue;
+		}
+		else if (sscanf(line, "shot %199s", arg) == 1)
+		{
+			shot(arg);
+			continue;
+		}
+		else if (strncmp(line, "serial ", 7) == 0)
+		{
+			line[strcspn(line, "\r\n")] = 0;
+			sim_serial_queue(line + 7);
+			continue;
+		}
+		else
+		{
+			continue;
+		}
+		
+		sim_pen_x = x;
+		sim_pen_y = y;
+		sim_pen_down = true;
+		press_end = now + ms;
+		release_end = press_end + TAP_TICKS;
+		return true;
+	}
+	
+	return false;
+}
+
+void sim_idle(void)						//the firmware has nothing to do: one Timer0 tick passes
+{
+	static bool done = false, ready = false;
+	
+	if (!ready)
+	{
+		printf("ready: %.1f ms busy waits, %lu commands, %lu data words\n", sim_busy_ms, sim_lcd_cmds, sim_lcd_data);
+		ready = true;
+	}
+	if (sim_pen_down && now >= press_end)
+	{
+		sim_pen_down = false;
+	}
+	if (!done && now >= release_end && !next_line())
+	{
+		done = true;
+		release_end = now + SETTLE_TICKS;
+	}
+	if (done && now >= release_end && !input_pending() && !sim_serial_pending())
+	{
+		if (out_path)
+		{
+			shot(out_path);
+		}
+		if (eeprom_path && !sim_eeprom_save(eeprom_path))
+		{
+			fprintf(stderr, "sim: can't write %s\n", eeprom_path);
+			exit(1);
+		}
+		exit(0);
+	}
+	
+	sim_eeprom_tick();
+	input_tick();
+	sched_tick();
+	now++;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc > 2 && strcmp(argv[1], "-e") == 0)
+	{
+		eeprom_path = argv[2];
+		sim_eeprom_load(eeprom_path);										//no image yet is a blank EEPROM
+		argv += 2;
+		argc -= 2;
+	}
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s [-e EEPROM.bin] SCRIPT [OUT.ppm]\n", argv[0]);
+		return 2;
+	}
+	
+	script = fopen(argv[1], "r");
+	if (!script)
+	{
+		fprintf(stderr, "sim: can't open %s\n", argv[1]);
+		return 1;
+	}
+	out_path = argc > 2 ? argv[2] : NULL;
+	
+	return firmware_main();
+}
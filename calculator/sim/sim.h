@@ -0,0 +1,35 @@
+/*
+ * sim.h
+ * Host simulator glue, force-included into every firmware file of the host build.
+ */ 
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*lcd_sim.c*/
+extern unsigned long sim_lcd_cmds, sim_lcd_data;	//bus writes since start
+extern unsigned long sim_lcd_reads;				//GRAM words read back
+bool sim_lcd_dump(const char *path);
+
+/*eeprom_sim.c*/
+extern unsigned int sim_eeprom_ms;				//write time of an EEPROM byte, the script's eeprom command
+extern unsigned int sim_eeprom_busy;			//ticks until the EEPROM is ready again
+void sim_eeprom_write(uint8_t *addr, uint8_t value, bool always);
+void sim_eeprom_tick(void);
+bool sim_eeprom_load(const char *path);			//EEMEM variables from an image, false if there is none
+bool sim_eeprom_save(const char *path);
+
+/*sim.c*/
+extern double sim_busy_ms;						//_delay_ms and _delay_us since start
+
+/*serial_sim.c*/
+void sim_serial_queue(const char *text);
+bool sim_serial_pending(void);
+
+/*touch_sim.c*/
+extern bool sim_pen_down;
+extern unsigned int sim_pen_x, sim_pen_y;	//screen coordinates, as key_at sees them
+
+#endif /* SIM_H_ */
@@ -0,0 +1,31 @@
+/*
+ * touch_sim.c
+ * Touch controller behind touch.h, driven by the script player in sim.c.
+ */ 
+#include "../touch.h"
+#include "sim.h"
+
+unsigned int T_X, T_Y;
+bool sim_pen_down = false;
+unsigned int sim_pen_x = 0, sim_pen_y = 0;
+
+void touch_init(void)
+{
+}
+
+bool touch_pressed(void)
+{
+	return sim_pen_down;
+}
+
+bool touch_read_xy(void)					//screen position back to a raw reading through the default calibration
+{
+	if (!sim_pen_down)
+	{
+		return false;
+	}
+	
+	T_X = sim_pen_x * 8 + 80 + 4;
+	T_Y = sim_pen_y * 6 + 80 + 3;
+	return true;
+}
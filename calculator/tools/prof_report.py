@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+"""Per-zone latency from a profiling dump (Debug build, hold CLR).
+
+    prof_report.py [DUMP]
+
+DUMP is the text the board sent over USART at 115200 8N1, e.g. saved with
+`stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > dump.txt`; stdin
+when left out. Zone names and the Timer1 prescaler come from prof.h.
+"""
+import os
+import re
+import sys
+
+F_CPU = 7372800
+PROF_H = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'prof.h')
+
+
+def read_header():
+    text = open(PROF_H).read()
+    names = re.findall(r'ZONE\(\w+,\s*"([^"]+)"\)', text)
+    prescale = int(re.search(r'#define PROF_PRESCALE (\d+)', text).group(1))
+    return names, prescale
+
+
+def main():
+    names, prescale = read_header()
+    src = open(sys.argv[1]) if len(sys.argv) > 1 else sys.stdin
+    open_marks = {}                     # zone -> stack of begin ticks
+    spans = {}                          # zone -> durations in ticks
+    in_dump = False
+
+    for line in src:
+        line = line.strip()
+        if line == 'PROF':
+            in_dump = True
+            open_marks.clear()          # marks don't pair across dumps
+            continue
+        if line == 'END':
+            in_dump = False
+            continue
+        parts = line.split()
+        if not in_dump or len(parts) != 3 or parts[0] not in ('B', 'E'):
+            continue
+        zone, ticks = int(parts[1], 16), int(parts[2], 16)
+        if parts[0] == 'B':
+            open_marks.setdefault(zone, []).append(ticks)
+        elif open_marks.get(zone):      # an end whose begin was overwritten in the ring is skipped
+            begin = open_marks[zone].pop()
+            spans.setdefault(zone, []).append((ticks - begin) & 0xffff)
+
+    us = prescale * 1e6 / F_CPU
+    print('%-16s %6s %10s %10s %10s' % ('zone', 'count', 'min us', 'avg us', 'max us'))
+    for zone in sorted(spans):
+        d = spans[zone]
+        name = names[zone] if zone < len(names) else 'zone %d' % zone
+        print('%-16s %6d %10.1f %10.1f %10.1f' % (name, len(d), min(d) * us, sum(d) * us / len(d), max(d) * us))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,49 @@
+#!/usr/bin/env python3
+"""Screenshot from the serial mode's shot command as a PPM.
+
+    shot.py [CAPTURE] OUT.ppm
+
+CAPTURE is the text the board sent over USART at 115200 8N1 after a line
+with just `shot`, stdin when left out; lines may carry the simulator's
+`serial> ` prefix. The board sends GRAM rows in address order, the panel
+is mounted rotated by 180 degrees, so the image is turned back here.
+"""
+import sys
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    src = open(sys.argv[1]) if len(sys.argv) > 2 else sys.stdin
+    out = sys.argv[-1]
+    size = None
+    px = []
+
+    for line in src:
+        line = line.strip()
+        if line.startswith('serial> '):
+            line = line[8:]
+        if line.startswith('SHOT '):
+            size = tuple(int(v) for v in line.split()[1:3])
+            px = []
+            continue
+        if size is None:
+            continue
+        if line == 'END':
+            break
+        px.extend(int(line[i:i + 4], 16) for i in range(0, len(line), 4))
+
+    if size is None:
+        sys.exit('no SHOT in the capture')
+    w, h = size
+    if len(px) != w * h:
+        sys.exit('expected %d pixels, got %d' % (w * h, len(px)))
+
+    with open(out, 'wb') as f:
+        f.write(b'P6\n%d %d\n255\n' % (w, h))
+        for c in reversed(px):          # last GRAM word is the viewer's top left
+            f.write(bytes((((c >> 11) & 0x1f) * 255 // 31, ((c >> 5) & 0x3f) * 255 // 63, (c & 0x1f) * 255 // 31)))
+
+
+if __name__ == '__main__':
+    main()
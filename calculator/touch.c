@@ -0,0 +1,164 @@
+/*
+ * touch.c
+ * Touch controller transport and the Timer0 tick that debounces it.
+ * Bit-banged on PORTD by default, define TOUCH_SPI_HW for the hardware SPI backend.
+ */ 
+#ifndef F_CPU
+#define F_CPU 7372800UL
+#endif
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <stdbool.h>
+#include "touch.h"
+#include "input.h"
+#include "sched.h"
+
+unsigned int T_X, T_Y;			//x and y coordinates
+
+bool getBit(int reg, int offset) {
+	return !!( (reg >> offset) & 1 );
+}
+
+#ifdef TOUCH_SPI_HW
+
+uint8_t touch_portb;					//LCD_DataHigh while SPI borrows PB5-PB7
+uint8_t touch_ddrb;						//inputs while an LCD read has the bus turned around
+
+void touch_bus_begin(void)				//SPI mode 0 at F_CPU/8, within the controller's 2 MHz limit
+{
+	touch_portb = PORTB;
+	touch_ddrb = DDRB;
+	DDRB |= _BV(PB4) | _BV(PB5) | _BV(PB7);	//SS an output so MSTR holds, MOSI and SCK driven
+	SPSR = _BV(SPI2X);
+	SPCR = _BV(SPE) | _BV(MSTR) | _BV(SPR0);
+}
+
+uint8_t touch_transfer(uint8_t out)
+{
+	SPDR = out;
+	while (!(SPSR & _BV(SPIF)));
+	return SPDR;
+}
+
+void touch_bus_end(void)				//give the pins back to the LCD bus as they were
+{
+	SPCR = 0;
+	PORTB = touch_portb;
+	DDRB = touch_ddrb;
+}
+
+#else
+
+void touch_bus_begin(void)
+{
+	PORTD &= ~_BV(T_CLK);
+}
+
+uint8_t touch_transfer(uint8_t out)		//same timing as SPI mode 0: DIN set before the rising edge, DOUT read on it
+{
+	uint8_t count, in = 0;
+	
+	for(count = 0; count < 8; count++){
+		if (out & 0x80) {
+			PORTD |= _BV(T_IN);
+		} else {
+			PORTD &= ~_BV(T_IN);
+		}
+		out <<= 1;
+		
+		PORTD |= _BV(T_CLK);			//controller latches T_IN
+		in <<= 1;
+		in |= getBit(PIND, T_OUT);		//T_OUT only changes on the falling edge
+		PORTD &= ~_BV(T_CLK);
+	}
+	
+	return in;
+}
+
+void touch_bus_end(void)
+{
+}
+
+#endif
+
+unsigned int touch_conversion(uint8_t cmd)	//24 clock conversion: command, busy clock, then 12 bits MSB first
+{
+	unsigned int value;
+	
+	touch_transfer(cmd);
+	value = touch_transfer(0) << 8;
+	value |= touch_transfer(0);
+	
+	return (value >> 3) & 0x0FFF;
+}
+
+unsigned int touch_filter(uint8_t cmd)		//TOUCH_SAMPLES conversions sorted, the outer ones dropped and the middle averaged
+{
+	unsigned int sample[TOUCH_SAMPLES], value, sum = 0;
+	uint8_t i, j;
+	
+	for (i = 0; i < TOUCH_SAMPLES; i++)
+	{
+		value = touch_conversion(cmd);
+		
+		for (j = i; j > 0 && sample[j - 1] > value; j--)
+		{
+			sample[j] = sample[j - 1];
+		}
+		sample[j] = value;
+	}
+	
+	for (i = TOUCH_TRIM; i < TOUCH_SAMPLES - TOUCH_TRIM; i++)
+	{
+		sum += sample[i];
+	}
+	
+	return sum / (TOUCH_SAMPLES - 2 * TOUCH_TRIM);
+}
+
+bool touch_read_xy(void)													//touch read x, y coordinate, false for a ghost touch
+{
+	unsigned int z1, z2;
+	bool valid;
+	
+	touch_bus_begin();
+	PORTD &= ~_BV(T_CS);													//to start transmission, CS is set to low
+	
+	z1 = touch_conversion(0xB0);											//pressure, z = Z1 + 4095 - Z2 grows with force
+	z2 = touch_conversion(0xC0);
+	valid = z1 + 4095 - z2 >= TOUCH_Z_MIN;
+	
+	if (valid)
+	{
+		T_Y = touch_filter(0x90);											//12 bit, differential, y position
+		T_X = touch_filter(0xD0);											//x position
+	}
+	
+	PORTD |= _BV(T_CS);														//to end transmission, CS is set to high
+	touch_bus_end();
+	
+	return valid;
+}
+
+bool touch_pressed(void)
+{
+	return getBit(PIND, T_IRQ) == 0;
+}
+
+void touch_init(void)														//Timer0 in CTC mode ticks input_tick and the scheduler at TICK_HZ
+{
+	DDRD |= _BV(T_IN) | _BV(T_CLK) | _BV(T_CS);
+	DDRD &= ~(_BV(T_OUT) | _BV(T_IRQ));										//input pins that read data
+	PORTD |= _BV(T_CS);
+	
+	OCR0 = F_CPU / 64 / TICK_HZ - 1;
+	TCCR0 = _BV(WGM01) | _BV(CS01) | _BV(CS00);
+	TIMSK |= _BV(OCIE0);
+}
+
+ISR(TIMER0_COMP_vect)
+{
+	input_tick();
+	sched_tick();
+}
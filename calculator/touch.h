@@ -0,0 +1,36 @@
+/*
+ * touch.h
+ * Touch controller on PORTD and the timer tick that samples it.
+ */ 
+#ifndef TOUCH_H_
+#define TOUCH_H_
+
+#include <stdbool.h>
+
+/*touch config*/
+#define T_IRQ PD0	//0 while the screen is touched
+#define T_OUT PD3	//get data from touch (serial)
+#define T_IN PD6	//send data (x, y coordinate) to touch
+#define T_CLK PD1   //touch controller clock
+#define T_CS PD2	//touch chip select
+/*end touch*/
+
+/*
+ * TOUCH_SPI_HW: DIN, DOUT and DCLK wired to PB5 (MOSI), PB6 (MISO) and PB7 (SCK)
+ * next to LCD D13-D15. SPI is only enabled while T_CS is low, PORTB and DDRB are
+ * restored after, so the tick may land in the middle of an LCD read.
+ */
+
+/*filtering*/
+#define TOUCH_SAMPLES 6		//conversions per axis
+#define TOUCH_TRIM 1		//dropped from each end after sorting
+#define TOUCH_Z_MIN 400		//lighter touches are ghosts
+/*end filtering*/
+
+extern unsigned int T_X, T_Y;		//last raw reading, only touched from the timer interrupt
+
+void touch_init(void);
+bool touch_pressed(void);
+bool touch_read_xy(void);
+
+#endif /* TOUCH_H_ */